@@ -0,0 +1,16 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 파일/네트워크 형식 공용: 리틀 엔디언 정수 인코딩과 CRC32 (IEEE)
+void put_le32(unsigned char* p, uint32_t v);
+void put_le64(unsigned char* p, uint64_t v);
+uint32_t get_le32(const unsigned char* p);
+uint64_t get_le64(const unsigned char* p);
+
+// 표는 처음 부를 때 한 번만 만듦 (여러 스레드에서 불러도 안전)
+uint32_t crc32(const unsigned char* p, size_t len);
+
+#endif
@@ -28,6 +28,8 @@
 #define MAX_ARROWS      50
 #define MAX_REDZONES    10
 #define MAX_PLAYERS     2
+#define TICK_USEC       50000   // 게임 한 틱 기본값 (20 FPS)
+#define TICK_HZ         (1000000 / TICK_USEC)
 
 // --- 네트워크 설정 (Network Settings) ---
 #define PORT            8888
@@ -58,7 +60,11 @@ typedef enum {
     ARROW_UPDATE,    // 화살 위치 업데이트
     REDZONE_UPDATE,  // 레드존 생성/삭제
     ITEM_USE,        // 아이템 사용
-    GAME_OVER        // 게임 종료
+    GAME_OVER,       // 게임 종료
+    STATE_UPDATE,    // 틱 단위 전체 상태 (롤백 기준점)
+    LOCKSTEP_START,  // 락스텝 시작 (시드/설정 합의, 이후 입력 프레임만 주고받음)
+    HEARTBEAT,       // 연결 생존 확인 (보낼 입력이 없을 때)
+    PACKET_TYPES
 } PacketType;
 
 // =========================================================
@@ -73,6 +79,7 @@ typedef struct {
     int active;
     int special;        // 0: 일반, 1: 특수 웨이브, 2: 플레이어 공격
     int owner;          // 공격을 발사한 플레이어 ID (-1: 환경 공격)
+    int born;           // 생성 프레임 (같은 슬롯의 화살끼리 구분)
 } Arrow;
 
 // 레드존 (RedZone)
@@ -83,6 +90,15 @@ typedef struct {
     int lifetime;
 } RedZone;
 
+// 지연 측정용 입력 추적: 서버가 마지막으로 적용한 입력의 번호와 단계별 시각
+// 시각은 CLOCK_MONOTONIC (나노초) 이라 같은 호스트의 프로세스끼리만 비교 가능
+typedef struct {
+    int input_id;           // 클라이언트가 붙인 입력 번호 (0: 없음)
+    long long sent_ns;      // 클라이언트 전송
+    long long recv_ns;      // 서버 수신 (입력 큐에 넣기 직전)
+    long long apply_ns;     // 틱 시작에서 적용
+} InputTrace;
+
 // 플레이어 (Player)
 typedef struct {
     // 위치 및 기본 정보
@@ -93,7 +109,7 @@ typedef struct {
     
     // 상태 정보 (Status)
     int lives;
-    int damage_cooldown;    // 피격 무적 시간
+    int damage_cooldown;    // 피격 무적 남은 틱
     
     // 아이템 보유 현황
     int invincible_item;
@@ -102,11 +118,52 @@ typedef struct {
     
     // 아이템 효과 상태
     int invincible;      // 무적 상태 여부
-    int invincible_frames;  // 무적 지속 프레임
+    int invincible_frames;  // 무적 남은 틱
     int slow;            // 감속 상태 여부
-    int slow_frames;        // 감속 지속 프레임
+    int slow_frames;        // 감속 남은 틱
+    int alive_ticks;        // 살아 있던 틱 수 (점수 환산용)
+
+    int ack_frame;          // 서버가 마지막으로 적용한 클라이언트 입력 프레임
+    InputTrace ack_trace;   // 서버가 마지막으로 적용한 입력 (지연 측정용)
 } Player;
 
+// 밸런스 상수 (배치 시뮬레이터에서 스윕 가능)
+// 시간은 밀리초, 빈도는 초 단위로 두고 틱 수로는 tick_hz 에 맞춰 변환하므로
+// 서버 틱 속도를 바꿔도 게임 밸런스는 그대로
+typedef struct {
+    int tick_hz;                // 시뮬레이션 틱 속도 (서버 --tick-hz)
+    int level_ms;               // 레벨 1 상승에 필요한 시간
+    int spawn_rate;             // 일반 화살 생성 빈도 (초당 생성 수 x100)
+    int spawn_rate_per_level;   // 레벨당 일반 화살 빈도 증가
+    int special_rate;           // 특수 웨이브 화살 생성 빈도 (초당 생성 수 x100)
+    int special_rate_per_level; // 레벨당 특수 웨이브 빈도 증가
+    int arrow_speed;            // 화살 속도 (초당 칸 수, 슬로우 중에는 절반)
+    int damage_cooldown_ms;     // 피격 후 무적 시간
+    int redzone_lifetime_ms;    // 레드존 지속 시간
+    int invincible_ms;          // 무적 아이템 지속 시간
+    int slow_ms;                // 슬로우 아이템 지속 시간
+    int wave_interval_ms;       // 특수 웨이브 주기
+    int wave_ms;                // 특수 웨이브 지속 시간
+    int redzone_interval_ms;    // 레드존 생성 주기
+    int attack_interval_ms;     // 플레이어 자동 공격 주기 (멀티 전용)
+} GameConfig;
+
+// 피격 원인
+typedef enum {
+    DAMAGE_ARROW,    // 일반 화살
+    DAMAGE_SPECIAL,  // 특수 웨이브 화살
+    DAMAGE_ATTACK,   // 상대 플레이어 공격
+    DAMAGE_REDZONE,  // 레드존
+    DAMAGE_SOURCES
+} DamageSource;
+
+// 게임 진행 통계 (시뮬레이션/분석용)
+typedef struct {
+    int damage[DAMAGE_SOURCES]; // 원인별 피격 횟수
+    int arrows_spawned;         // 생성된 화살 수
+    int spawn_drops;            // 화살 풀이 가득 차서 버려진 생성 수
+} GameStats;
+
 // =========================================================
 // [5] 전체 게임 상태 구조체 (Game State)
 // =========================================================
@@ -117,8 +174,12 @@ typedef struct {
     RedZone redzone[MAX_REDZONES];
     Player player[MAX_PLAYERS];
     int frame;
-    int special_wave;
+    int special_wave;       // 특수 웨이브 남은 틱
     bool multiplay;
+    bool lockstep;          // 락스텝 모드 (입력만 전송, 각자 시뮬레이션)
+    unsigned int seed;      // 게임 전용 난수 상태 (rand_r)
+    GameConfig config;
+    GameStats stats;
 } GameState;
 
 // =========================================================
@@ -134,6 +195,10 @@ typedef struct {
     // 개별 업데이트용 필드
     int x, y;
     int item_type; // PACKET_ITEM_USE 시 사용
+    int frame;     // 입력: 클라이언트 프레임, STATE_UPDATE: 서버 프레임
+    int input_id;       // 입력: 지연 측정용 번호 (0: 없음)
+    int view_frame;     // 입력: 입력을 낼 때 화면에 그려져 있던 프레임 (예측 포함, 랙 보정 기준, -1: 아직 없음)
+    long long sent_ns;  // 입력: 클라이언트 전송 시각, STATE_UPDATE: 서버 전송 시각
     
     // 대규모 데이터 동기화용 필드
     Arrow arrows[MAX_ARROWS];
@@ -167,6 +232,8 @@ void show_message(const char* title, const char* message);
 // score.c 에 정의된 점수 관련 함수
 long highScore(void);
 void saveScore(const char* name, int score, const char* mode);
+int submitScore(const char* name, int score, const char* mode, int* rank, int* total);
 void handleScoreboard(void);
+void startScoreCompaction(void);
 
 #endif // COMMON_H
\ No newline at end of file
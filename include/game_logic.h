@@ -6,21 +6,37 @@
 
 #define GAME_WIDTH 90
 #define GAME_HEIGHT 26
+#define SCORE_PER_SECOND 20     // 점수 = 생존 시간 (예전 20 FPS 프레임 수와 같은 단위)
 
 
+void default_config(GameConfig* config);
+void seed_game(GameState* game_state, unsigned int seed);
 void init_game(GameState* game_state, bool is_multiplayer);
 
+// 설정의 시간을 현재 틱 속도의 틱 수로 (반올림, 최소 1틱)
+int config_ticks(const GameConfig* config, int ms);
+long long config_tick_ns(const GameConfig* config);
+long long game_elapsed_ms(const GameState* state);
+int game_level(const GameState* state);
+
 void update_game(GameState* state, int width, int height);
-void update_player(Player* player);
+void update_player(Player* player, const GameConfig* config);
 void update_arrows(GameState* state, int width, int height);
 void update_redzones(GameState* state);
-void damage(Player* player);
+void move_player(Player* player, int dx, int dy);
+int damage(Player* player, const GameConfig* config);
 void check_collisions(GameState* state, int width, int height);
+// 플레이어 idx 를 arrows 기준으로 판정 (맞은 화살은 arrows 와 state 양쪽에서 제거)
+void check_arrow_hits(GameState* state, int idx, Arrow* arrows);
+void check_redzone_hits(GameState* state, int idx);
+// update_game 의 충돌 판정 교체 (서버 랙 보정). NULL 이면 check_collisions
+void set_collision_handler(void (*handler)(GameState* state, int width, int height));
 
 void spawn_arrow(GameState* state, int width, int height, bool is_special, int target_player_id);
 void redZone(GameState* state, int width, int height);
 void create_player_attack(GameState* state, int player_id);
 void trigger_special_wave(GameState* state);
+void update_events(GameState* state, int width, int height);
 
 void update_game_world(GameState* state, int width, int height);
 
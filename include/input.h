@@ -0,0 +1,40 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdio.h>
+
+#define INPUT_QUEUE 256         // 아직 적용하지 않은 키 (가득 차면 tty 에 남겨 두고 다음에 읽음)
+
+// 키 입력 하나와 읽은 시각
+typedef struct {
+    int key;
+    long long ts_ns;            // CLOCK_MONOTONIC
+} KeyEvent;
+
+// 도착 순서대로 쌓아 두는 키 큐 (그리는 스레드 전용)
+typedef struct {
+    KeyEvent events[INPUT_QUEUE];
+    int head;
+    int count;
+    long long unshown_ns;       // 아직 화면에 반영되지 않은 가장 오래된 키 시각 (0: 없음)
+
+    // 측정값
+    long long keys;             // 읽은 키 수
+    long long latency_sum_ns;   // 키 -> 화면 반영
+    long long latency_max_ns;
+    long long latency_count;
+} InputQueue;
+
+void input_init(InputQueue* q);
+void input_clear(InputQueue* q);    // 쌓인 키만 비움 (측정값 유지)
+// stdin 에 읽을 키가 생기거나 timeout_us 가 지날 때까지 대기 (키가 있으면 1)
+int input_wait(long long timeout_us);
+// tty 에 쌓인 키를 모두 읽어 큐에 넣음, 새로 읽은 키 수 반환
+int input_drain(InputQueue* q);
+int input_pop(InputQueue* q, KeyEvent* ev);
+const KeyEvent* input_peek(const InputQueue* q, int index);
+// 지금까지 읽은 키가 화면에 나간 시각 기록
+void input_shown(InputQueue* q, long long shown_ns);
+void input_report(const InputQueue* q, const char* tag, FILE* out);
+
+#endif
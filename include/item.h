@@ -3,9 +3,9 @@
 
 #include "common.h"
 
-void invincible_item(Player* player);
+void invincible_item(Player* player, const GameConfig* config);
 void heal_item(Player* player);
-void slow_item(Player* player);
-void damage(Player* player);
+void slow_item(Player* player, const GameConfig* config);
+int damage(Player* player, const GameConfig* config);
 
 #endif
\ No newline at end of file
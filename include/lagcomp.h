@@ -0,0 +1,43 @@
+#ifndef LAGCOMP_H
+#define LAGCOMP_H
+
+#include <stddef.h>
+#include "common.h"
+
+#define LAGCOMP_HISTORY     64      // 보관하는 틱 수 (되감기 상한의 최댓값)
+#define LAGCOMP_DEFAULT_MS  200     // 기본 되감기 상한
+
+// 서버 랙 보정
+// 입력이 늦게 도착하는 플레이어는 서버의 지금 화살이 아니라 그 입력을 낼 때 보고 있던 틱의 화살로
+// 피격을 판정함 (화면에서 이미 피한 화살에 맞지 않도록). 되감는 폭은 입력 지각의 EWMA, 상한은 max_ticks
+typedef struct {
+    int frame[LAGCOMP_HISTORY];                 // 기록한 틱 (-1 이면 빈 칸)
+    Arrow arrow[LAGCOMP_HISTORY][MAX_ARROWS];   // 그 틱 충돌 판정 시점의 화살
+    int lag_x16[MAX_PLAYERS];                   // 입력 지각 틱 수 EWMA (x16)
+    int max_ticks;                              // 되감기 상한 (0 이면 끔)
+
+    // 측정값
+    long long ticks;            // 판정한 틱 수
+    long long checks;           // 플레이어별 판정 횟수
+    long long rewinds;          // 그중 되감아 판정한 횟수
+    long long rewind_ticks;     // 되감은 틱 수 합
+    long long forgiven;         // 지금 화살로는 맞지만 본 화면 기준으로는 피한 판정
+    long long late_hits;        // 지금 화살로는 피했지만 본 화면 기준으로는 맞은 판정
+    long long check_ns;         // 판정 누적 시간 (기록 복사 포함)
+    long long check_max_ns;
+} LagComp;
+
+void lagcomp_init(LagComp* lc, int max_ms, int tick_hz);
+void lagcomp_reset(LagComp* lc);    // 새 판: 기록과 지각 추정만 비우고 측정값은 유지
+
+// id 플레이어의 입력을 서버 프레임 server_frame 에 적용
+// view_frame: 입력을 낼 때 클라이언트 화면에 그려져 있던 프레임 (지각 = server_frame - view_frame)
+// 화살은 같은 시드로 결정되므로 롤백 예측 클라이언트가 그린 프레임의 화살은 서버의 그 프레임 화살과 같음
+void lagcomp_input(LagComp* lc, int id, int view_frame, int server_frame);
+// update_game 의 충돌 판정 대신 호출 (이번 틱 화살을 기록한 뒤 플레이어별로 되감아 판정)
+void lagcomp_collisions(LagComp* lc, GameState* state);
+int lagcomp_rewind(const LagComp* lc, int id);
+
+void lagcomp_report(const LagComp* lc, char* buf, size_t size);   // 한 줄 요약
+
+#endif
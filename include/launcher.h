@@ -1,10 +1,15 @@
 #ifndef LAUNCHER_H
 #define LAUNCHER_H
 
+// 런처가 띄운 서버/클라이언트의 로그 파일 접두사 (<접두사>.server.log, <접두사>.client.log)
+// SPACEWAR_LOG 가 이미 있으면 그대로 씀
+#define LAUNCHER_LOG_PREFIX "spacewar"
+
 void handleSingleplay(void);
 void handleMultihost(void);
 void handleMultijoin(void);
 void cleanServer(void);
 void gameResult(const char* temp_file, const char* player_name, const char* mode_str);
+void showGameResult(int score, const char* player_name, const char* mode_str);
 
 #endif
\ No newline at end of file
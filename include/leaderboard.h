@@ -0,0 +1,55 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include "common.h"
+
+// 리더보드 데몬 (bin/leaderboard) 과 주고받는 고정 크기 메시지
+// 정수는 리틀 엔디언, 기록은 점수 파일 v2 레코드 (48B) 형식 그대로
+//   요청 64B : op u32 | rank u32 | count u32 | 예약 u32 | 기록 48B
+//   응답 16B : status u32 | total u32 | first_rank u32 | count u32, 그 뒤 기록 count 개
+#define LB_DEFAULT_SOCKET "leaderboard.sock"
+#define LB_DEFAULT_WAL    "leaderboard.wal"
+#define LB_REQUEST_SIZE   64
+#define LB_RESPONSE_SIZE  16
+#define LB_MAX_ROWS       50        // 한 번에 돌려주는 최대 기록 수
+#define LB_TIMEOUT_MS     500       // 데몬이 응답하지 않으면 포기 (메뉴가 멈추지 않도록)
+
+typedef enum {
+    LB_SUBMIT = 1,      // 기록 제출 (플레이어/모드별 최고 기록만 순위에 남음)
+    LB_TOP,             // 모드별 상위 count 개
+    LB_RANK,            // 플레이어 순위 (기록의 name/mode)
+    LB_AROUND           // rank 주변 count 개
+} LbOp;
+
+typedef enum {
+    LB_OK = 0,
+    LB_NOT_FOUND,
+    LB_BAD_REQUEST,
+    LB_ERROR
+} LbStatus;
+
+typedef struct {
+    int status;
+    int total;          // 그 모드의 플레이어 수
+    int first_rank;     // rows[0] 의 순위 (1 부터)
+    int count;
+    ScoreEntry rows[LB_MAX_ROWS];
+} LbResult;
+
+// 주소: 환경 변수 SPACEWAR_LEADERBOARD ("host:port" 면 TCP, 아니면 유닉스 소켓 경로)
+//       없으면 LB_DEFAULT_SOCKET
+const char* lb_address(void);
+int lb_connect(const char* address);    // 실패 시 -1
+
+// 요청 하나 보내고 응답 받기 (통신 실패 시 -1)
+int lb_submit(int fd, const ScoreEntry* entry, LbResult* result);
+int lb_top(int fd, const char* mode, int count, LbResult* result);
+int lb_rank(int fd, const char* name, const char* mode, LbResult* result);
+int lb_around(int fd, const char* mode, int rank, int count, LbResult* result);
+
+// 메시지 인코딩 (데몬과 공유)
+void lb_encode_request(unsigned char* buf, int op, int rank, int count, const ScoreEntry* entry);
+void lb_decode_request(const unsigned char* buf, int* op, int* rank, int* count, ScoreEntry* entry);
+void lb_encode_response(unsigned char* buf, int status, int total, int first_rank, int count);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <stdint.h>
+#include "common.h"
+
+#define LOCKSTEP_DELAY   3      // 입력 지연 버퍼 (프레임)
+#define LOCKSTEP_WINDOW  64     // 보관하는 입력 프레임 수 (지연보다 충분히 커야 함)
+#define LOCKSTEP_END     0xFF   // item 값: 게임 종료 (id 는 승자, 0xFF 는 무승부)
+#define LOCKSTEP_HEARTBEAT 0xFE // item 값: 연결 생존 확인 (입력 아님)
+
+// 한 플레이어의 한 프레임 입력 (전송 시 8바이트)
+typedef struct {
+    int32_t frame;
+    uint8_t id;
+    int8_t dx, dy;
+    uint8_t item;       // 0: 없음, 1~3: 아이템, LOCKSTEP_END: 종료 알림, LOCKSTEP_HEARTBEAT: 하트비트
+} LockstepInput;
+
+// 프레임별 입력 버퍼
+typedef struct {
+    LockstepInput input[LOCKSTEP_WINDOW][MAX_PLAYERS];
+    int delay;
+    long long stalls;       // 상대 입력이 없어 진행하지 못한 횟수
+    long long frames;       // 진행한 프레임 수
+} Lockstep;
+
+void lockstep_init(Lockstep* ls, int delay);
+// current_frame: 지금 진행할 프레임, [current_frame, current_frame + LOCKSTEP_WINDOW) 밖의 입력은 거절 (-1)
+int lockstep_add(Lockstep* ls, const LockstepInput* input, int current_frame);
+int lockstep_ready(const Lockstep* ls, const GameState* state);
+void lockstep_advance(Lockstep* ls, GameState* state);
+
+int lockstep_send(int fd, const LockstepInput* input);
+int lockstep_recv(int fd, LockstepInput* input);
+
+#endif
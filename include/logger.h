@@ -0,0 +1,72 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdatomic.h>
+
+#define LOG_MSG_SIZE        200     // 한 줄 최대 길이 (넘으면 자름)
+#define LOG_RING_RECORDS    256     // 스레드별 대기 레코드 수 (넘치면 버리고 셈)
+#define LOG_MAX_THREADS     16
+#define LOG_FLUSH_MS        100     // 기록 스레드가 모아 쓰는 주기 (경고 이상은 바로 깨움)
+#define LOG_RATE_PER_SEC    20      // 호출 위치별 초당 최대 줄 수 (넘은 줄은 세어서 다음 줄에 표시)
+#define LOG_ROTATE_BYTES    (1024 * 1024)
+#define LOG_KEEP            3       // <파일>.1 ... <파일>.LOG_KEEP
+
+typedef enum {
+    LOG_DEBUG,
+    LOG_INFO,
+    LOG_WARN,
+    LOG_ERROR,
+    LOG_LEVELS
+} LogLevel;
+
+// 호출 위치 (매크로가 위치마다 static 으로 하나씩 만듦, 속도 제한 상태)
+typedef struct {
+    const char* file;
+    int line;
+    atomic_llong window;        // 지금 세고 있는 초
+    atomic_int count;           // 그 초에 남긴 줄 수
+    atomic_int suppressed;      // 속도 제한으로 버린 줄 수 (다음 줄에 붙여 출력)
+} LogSite;
+
+// 로그 측정값 (메트릭용)
+typedef struct {
+    atomic_llong records[LOG_LEVELS];
+    atomic_llong dropped;       // 스레드 링이 가득 차 버린 줄
+    atomic_llong suppressed;    // 속도 제한으로 버린 줄
+} LogStats;
+
+extern atomic_int log_level;    // 이보다 낮은 수준은 호출 위치에서 바로 건너뜀
+extern LogStats log_stats;
+
+// 환경 변수로 설정하고 기록 스레드 시작
+//   SPACEWAR_LOG=<경로 접두사> 면 <접두사>.<process>.log (회전), 없으면 표준 에러
+//   SPACEWAR_LOG_LEVEL=debug|info|warn|error (기본 info)
+void log_init_env(const char* process);
+// 현재 스레드 이름 지정 (처음 기록 전에 호출)
+void log_thread(const char* name);
+// 수준 변경 (환경 변수보다 우선, 시그널로 debug 를 껐을 때 돌아갈 수준)
+void log_set_level(LogLevel level);
+// 이 시그널을 받을 때마다 debug 수준과 설정된 수준을 오감
+void log_toggle_signal(int sig);
+int log_parse_level(const char* name);     // 모르는 이름이면 -1
+const char* log_level_name(LogLevel level);
+// 남은 줄을 모두 쓰고 기록 스레드 종료 (log_init_env 가 atexit 에 등록)
+void log_stop(void);
+
+void log_write(LogSite* site, LogLevel level, const char* fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+// 수준 확인과 속도 제한 뒤 포맷해서 스레드 링에 넣기만 함 (파일 쓰기는 기록 스레드)
+#define LOG_AT(level, ...) do { \
+        if ((int)(level) >= atomic_load_explicit(&log_level, memory_order_relaxed)) { \
+            static LogSite log_site_ = { __FILE__, __LINE__, 0, 0, 0 }; \
+            log_write(&log_site_, (level), __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define log_debug(...) LOG_AT(LOG_DEBUG, __VA_ARGS__)
+#define log_info(...)  LOG_AT(LOG_INFO, __VA_ARGS__)
+#define log_warn(...)  LOG_AT(LOG_WARN, __VA_ARGS__)
+#define log_error(...) LOG_AT(LOG_ERROR, __VA_ARGS__)
+
+#endif
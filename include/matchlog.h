@@ -0,0 +1,84 @@
+#ifndef MATCHLOG_H
+#define MATCHLOG_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+#include "common.h"
+
+// 판 기록 파일 형식: 고정 크기 레코드를 이어 붙이기만 함, 모든 정수는 리틀 엔디언
+//   레코드 160B: "SWMH" | version u32 | started i64 | duration_ms u32 | frames u32 | tick_hz u32 | winner i32
+//                | flags u32 | ticks u32 | tick_mean_ns u32 | tick_max_ns u32 | tick_overruns u32
+//                | arrows_spawned u32 | spawn_drops u32 | damage[4] u32            (여기까지 76B)
+//                | 플레이어 2 x 40B (flags | lives | score | alive_ticks | hits | items_used[3] | moves | input_drops)
+//                | crc32 u32 (앞 156B 의 체크섬, 156..160)
+// 파일이 MATCHLOG_ROTATE_BYTES 를 넘으면 <경로>.1 ... <경로>.MATCHLOG_KEEP 으로 밀어내고 새 파일을 염
+#define MATCHLOG_DEFAULT_PATH   "matches.log"
+#define MATCHLOG_VERSION        1
+#define MATCHLOG_RECORD_SIZE    160
+#define MATCHLOG_ROTATE_BYTES   (4 * 1024 * 1024)
+#define MATCHLOG_KEEP           4
+#define MATCHLOG_QUEUE          64      // 쓰기 대기 레코드 수 (넘치면 버리고 셈)
+#define MATCHLOG_SYNC_MS        1000    // 쓴 레코드를 디스크에 내리는 최대 간격
+#define MATCHLOG_SYNC_RECORDS   32      // 이만큼 쌓이면 간격과 관계없이 내림
+
+#define MATCHLOG_LOCKSTEP       0x1     // flags: 락스텝 판
+#define MATCHLOG_DISCONNECT     0x2     // flags: 연결 끊김으로 끝남
+#define MATCHLOG_LAGCOMP        0x4     // flags: 랙 보정 켜짐
+#define MATCHLOG_CONNECTED      0x1     // 플레이어 flags: 끝날 때 연결되어 있었음
+
+typedef struct {
+    int flags;
+    int lives;
+    int score;
+    int alive_ticks;
+    int hits;                   // 피격 횟수
+    int items_used[3];          // 무적 / 회복 / 감속
+    int moves;                  // 적용한 이동 입력 수
+    int input_drops;            // 입력 큐가 가득 차 버린 입력 수
+} MatchPlayer;
+
+// 판 하나의 요약 (틱 스레드가 채워서 matchlog_submit)
+typedef struct {
+    long long started;          // 시작 시각 (유닉스 초)
+    int duration_ms;
+    int frames;
+    int tick_hz;
+    int winner;                 // -1: 승자 없음
+    int flags;
+    int ticks;                  // 시간을 잰 틱 수
+    int tick_mean_ns;
+    int tick_max_ns;
+    int tick_overruns;          // 틱 예산 초과
+    int arrows_spawned;
+    int spawn_drops;
+    int damage[DAMAGE_SOURCES]; // 원인별 피격 (두 플레이어 합)
+    MatchPlayer player[MAX_PLAYERS];
+} MatchRecord;
+
+// 쓰기 측정값 (dropped 는 틱 스레드, 나머지는 기록 스레드가 갱신하고 메트릭 스레드가 읽음)
+typedef struct {
+    atomic_llong written;       // 파일에 쓴 레코드
+    atomic_llong dropped;       // 대기열이 가득 차 버린 레코드
+    atomic_llong failed;        // 쓰기 실패로 잃은 레코드
+    atomic_llong syncs;         // fdatasync 횟수
+    atomic_llong sync_ns;       // fdatasync 누적 시간
+    atomic_llong rotations;
+} MatchLogStats;
+
+extern MatchLogStats matchlog_stats;
+
+// 기록 스레드 시작 (실패 시 -1, 이후 matchlog_submit 은 아무것도 하지 않음)
+int matchlog_start(const char* path);
+// 틱 스레드 전용: 대기열에 넣기만 하고 바로 돌아옴 (가득 차면 -1)
+int matchlog_submit(const MatchRecord* record);
+// 남은 레코드를 모두 쓰고 디스크에 내린 뒤 기록 스레드 종료
+void matchlog_stop(void);
+unsigned int matchlog_pending(void);
+
+void matchlog_encode(unsigned char* p, const MatchRecord* record);
+int matchlog_decode(const unsigned char* p, MatchRecord* record);  // 깨진 레코드면 -1
+
+// 회전된 파일부터 시간순으로 레코드를 한 줄씩 출력, 출력한 레코드 수 반환
+long long matchlog_dump(const char* path, FILE* out);
+
+#endif
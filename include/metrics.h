@@ -0,0 +1,62 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "common.h"
+
+#define METRICS_TICK_BUCKETS 10
+#define METRICS_LOCKSTEP PACKET_TYPES   // 락스텝 입력 프레임은 Packet 이 아니라 따로 셈
+#define METRICS_DEAD_BUCKETS 8
+
+// 연결이 끊긴 원인
+typedef enum {
+    DISCONNECT_CLOSED,      // 상대가 연결을 닫음 (정상 종료, RST)
+    DISCONNECT_IDLE,        // NET_IDLE_TIMEOUT_MS 동안 아무것도 받지 못함 (하트비트 끊김)
+    DISCONNECT_KEEPALIVE,   // 커널이 죽은 상대로 판정 (keepalive, TCP_USER_TIMEOUT)
+    DISCONNECT_SEND,        // 전송 실패 또는 시간 초과
+    DISCONNECT_REASONS
+} DisconnectReason;
+
+// 서버 상태 지표 (틱/연결 스레드가 갱신, 메트릭 스레드가 읽음)
+typedef struct {
+    atomic_int connected;           // 연결된 클라이언트 수
+    atomic_int matches_active;      // 진행 중인 판 수
+    atomic_llong matches_total;     // 시작된 판 수
+    atomic_int arrows_active;       // 화살 풀 사용량
+    atomic_int redzones_active;     // 레드존 풀 사용량
+
+    atomic_llong ticks;
+    atomic_llong tick_sum_ns;
+    atomic_llong tick_buckets[METRICS_TICK_BUCKETS];    // 구간별 (누적 아님)
+    atomic_llong tick_overruns;     // 틱 예산 초과
+
+    atomic_llong packets_out[PACKET_TYPES + 1];
+    atomic_llong bytes_out[PACKET_TYPES + 1];
+    atomic_llong packets_in[PACKET_TYPES + 1];
+    atomic_llong bytes_in[PACKET_TYPES + 1];
+    atomic_llong send_errors;
+    atomic_llong input_drops;       // 입력 큐가 가득 차 버린 입력
+
+    atomic_llong disconnects[DISCONNECT_REASONS];
+    atomic_llong dead_peers;        // 정상 종료가 아닌 끊김 (감지 시간 히스토그램 대상)
+    atomic_llong dead_peer_sum_ns;
+    atomic_llong dead_peer_buckets[METRICS_DEAD_BUCKETS];  // 구간별 (누적 아님)
+} Metrics;
+
+extern Metrics metrics;
+extern int metrics_enabled;
+
+// 127.0.0.1:port 에서 Prometheus 텍스트 형식으로 응답하는 스레드 시작
+// extra 가 있으면 응답 끝에 호출 측 지표를 덧붙임
+int metrics_start(int port, long long tick_budget_ns, void (*extra)(FILE* out));
+
+void metrics_tick(long long elapsed_ns);
+void metrics_packet_out(int type, size_t bytes);
+void metrics_packet_in(int type, size_t bytes);
+// 연결 해제 기록 (silent_ns: 마지막으로 받은 뒤 자리를 비우기까지 걸린 시간)
+void metrics_disconnect(DisconnectReason reason, long long silent_ns);
+const char* disconnect_name(DisconnectReason reason);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef NET_H
+#define NET_H
+
+#include <stddef.h>
+
+// TCP 스트림에서 len 바이트를 모두 읽기/쓰기 (실패 또는 연결 종료 시 -1)
+int net_read_full(int fd, void* buf, size_t len);
+int net_write_full(int fd, const void* buf, size_t len);
+
+// 죽은 상대 감지
+// 보낼 입력이 없어도 NET_HEARTBEAT_MS 마다 하트비트를 보내고,
+// 서버는 NET_IDLE_TIMEOUT_MS 동안 아무것도 받지 못하면 연결을 끊고 자리를 비움
+#define NET_HEARTBEAT_MS     500
+#define NET_IDLE_TIMEOUT_MS  2000
+// 틱 스레드가 한 상대에게 보내다 기다리는 최대 시간 (송신 버퍼가 가득 찬 상대는 이 안에 끊김)
+#define NET_SEND_TIMEOUT_MS  5
+// TCP keepalive (조용한 연결) 와 TCP_USER_TIMEOUT (ACK 없는 전송) 이 timeout_ms 안팎에 끊기도록 설정
+void net_keepalive(int fd, int timeout_ms);
+// 읽기가 recv_ms, 쓰기가 send_ms 동안 진척이 없으면 net_read_full/net_write_full 이 -1 (errno EAGAIN)
+void net_io_timeout(int fd, int recv_ms, int send_ms);
+
+// 준비 알림: 부모가 넘긴 파이프의 쓰기 끝 fd 번호를 환경 변수 NET_READY_ENV 로 받아
+// 준비되면 "OK\n", 시작에 실패하면 "ERR <이유>\n" 한 줄을 쓰고 닫음 (환경 변수가 없으면 아무것도 안 함)
+#define NET_READY_ENV        "SPACEWAR_READY_FD"
+#define NET_READY_TIMEOUT_MS 5000
+void net_notify_ready(const char* error);       // error 가 NULL 이면 준비 완료
+// 파이프 읽기 끝에서 알림 대기: 준비되면 0, 실패/종료/시간 초과면 -1 과 error 에 이유
+int net_wait_ready(int fd, int timeout_ms, char* error, size_t size);
+
+// 패킷 종류 이름 (PACKET_TYPES 는 락스텝 입력 프레임)
+const char* packet_name(int type);
+
+#endif
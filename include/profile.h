@@ -0,0 +1,50 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include "timeutil.h"
+
+#define PROF_WINDOW 1024    // 구간별로 보관하는 최근 샘플 수
+
+// 틱 안에서 측정하는 구간
+typedef enum {
+    PROF_LOCK_WAIT,     // 틱 시작 시 게임 락 대기
+    PROF_INPUT,         // 입력 큐 비우기 / 키 입력 처리
+    PROF_PLAYERS,       // update_game: 플레이어 타이머
+    PROF_ARROWS,        // update_game: 화살 이동
+    PROF_REDZONES,      // update_game: 레드존 수명
+    PROF_COLLISIONS,    // update_game: 충돌 판정
+    PROF_SPAWN,         // update_game: 화살 생성
+    PROF_EVENTS,        // 웨이브/레드존/공격 이벤트
+    PROF_SERIALIZE,     // 전송 패킷 구성
+    PROF_SEND,          // 소켓 쓰기
+    PROF_RENDER,        // 화면 그리기
+    PROF_TICK,          // 틱 전체 (sleep 제외)
+    PROF_PHASES
+} ProfPhase;
+
+// 구간별 최근 샘플 (나노초)
+typedef struct {
+    long long samples[PROF_WINDOW];
+    unsigned int next;          // 다음에 쓸 위치
+    long long count;            // 누적 샘플 수
+    long long max_ns;           // 누적 최댓값
+} ProfHistogram;
+
+// 프로파일러가 켜져 있는지 (꺼져 있으면 측정 비용 없음)
+extern int prof_enabled;
+
+// interval_sec 마다 (0 이면 SIGUSR1 때만) out 으로 출력, budget_ns 를 넘긴 틱 수도 셈
+void prof_init(int interval_sec, long long budget_ns, FILE* out);
+// 환경 변수 SPACEWAR_PROFILE=<초> 가 있으면 켬
+void prof_init_env(long long budget_ns, FILE* out);
+
+static inline long long prof_begin(void) {
+    return prof_enabled ? now_ns() : 0;
+}
+
+void prof_end(ProfPhase phase, long long start);
+void prof_poll(void);           // 틱 끝에서 호출: 요청/주기가 되면 출력
+void prof_dump(FILE* out);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef RANKLIST_H
+#define RANKLIST_H
+
+#include "common.h"
+
+#define RANK_MAX_LEVEL 32
+
+// 순위를 셀 수 있는 스킵 리스트 (각 링크가 건너뛰는 노드 수를 함께 저장)
+// 삽입/삭제/순위/k 번째 조회 모두 평균 O(log n)
+typedef struct RankNode {
+    ScoreEntry entry;
+    int level;
+    struct {
+        struct RankNode* next;
+        int span;               // next 까지 건너뛰는 노드 수
+    } link[];
+} RankNode;
+
+typedef struct {
+    RankNode* head;
+    int level;
+    int length;
+    unsigned int seed;
+} RankList;
+
+// 순서: 점수 내림차순, 같으면 최신 먼저, 그다음 이름/모드 (같은 키면 0)
+int rank_compare(const ScoreEntry* a, const ScoreEntry* b);
+
+int rank_init(RankList* list, unsigned int seed);
+void rank_free(RankList* list);
+
+int rank_insert(RankList* list, const ScoreEntry* entry);
+int rank_remove(RankList* list, const ScoreEntry* entry);    // 없으면 -1
+
+// 1 부터 시작하는 순위 (없으면 0)
+int rank_of(const RankList* list, const ScoreEntry* entry);
+// rank 번째 노드 (1 부터, 범위 밖이면 NULL), 다음 노드는 node->link[0].next
+const RankNode* rank_at(const RankList* list, int rank);
+
+#endif
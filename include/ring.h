@@ -0,0 +1,24 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+// 단일 생산자/단일 소비자 고정 크기 링 버퍼 (락 없음)
+// 생산자와 소비자가 각각 한 스레드일 때만 안전함
+typedef struct {
+    _Alignas(64) atomic_uint head;   // 소비자가 다음에 읽을 위치
+    _Alignas(64) atomic_uint tail;   // 생산자가 다음에 쓸 위치
+    _Alignas(64) unsigned int mask;  // 용량 - 1 (용량은 2의 거듭제곱)
+    size_t elem_size;
+    unsigned char* buf;
+} Ring;
+
+int ring_init(Ring* ring, size_t elem_size, unsigned int capacity);
+void ring_free(Ring* ring);
+int ring_push(Ring* ring, const void* elem);
+int ring_pop(Ring* ring, void* elem);
+void ring_clear(Ring* ring);
+unsigned int ring_count(Ring* ring);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "common.h"
+
+#define ROLLBACK_FRAMES 32      // 보관하는 프레임 수 (20 FPS 기준 약 1.6초)
+#define ROLLBACK_SLACK  2       // 목표 리드에서 이만큼 벗어나도 타임라인 유지
+
+// 한 프레임 동안 내가 적용한 입력
+typedef struct {
+    int moved;          // 이동 여부
+    int x, y;           // 이동 후 위치 (서버에 보내는 값과 동일)
+    int item;           // 사용한 아이템 (0: 없음)
+} FrameInput;
+
+// 프레임 시작 시점의 상태와 그 프레임의 입력
+typedef struct {
+    int frame;          // -1 이면 빈 슬롯
+    long long time_ns;  // 기록 시각 (RTT 측정용)
+    GameState state;
+    FrameInput input;
+} RollbackSlot;
+
+typedef struct {
+    RollbackSlot slot[ROLLBACK_FRAMES];
+    int my_id;
+    int last_ack;               // 마지막으로 확인한 서버 ack_frame
+    long long rtt_ns;           // 입력 -> 서버 반영 확인까지 왕복 시간 (EWMA)
+    int lead;                   // 서버 확정 프레임보다 앞서 예측할 프레임 수
+
+    // 측정값
+    long long saves;            // 저장한 프레임 수
+    long long save_ns;          // 저장(복사) 누적 시간
+    long long corrections;      // 서버 상태 수신 횟수
+    long long matches;          // 예측이 맞아 되감기 생략
+    long long rollbacks;        // 되감기 + 재시뮬레이션 횟수
+    long long resim_frames;     // 재시뮬레이션한 프레임 수
+    long long resim_ns;         // 재시뮬레이션 누적 시간
+    long long resim_max_ns;     // 1회 최대 재시뮬레이션 시간
+    long long hard_resets;      // 기록 밖이라 서버 상태로 바로 교체
+} Rollback;
+
+void rollback_init(Rollback* rb, int my_id);
+void rollback_reset(Rollback* rb, int my_id);
+void rollback_apply_input(GameState* state, int id, const FrameInput* input);
+void rollback_step(GameState* state);
+void rollback_save(Rollback* rb, const GameState* state, const FrameInput* input);
+void rollback_correct(Rollback* rb, GameState* live, const GameState* confirmed);
+void rollback_report(const Rollback* rb, FILE* out);
+
+#endif
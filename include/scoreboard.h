@@ -0,0 +1,113 @@
+#ifndef SCOREBOARD_H
+#define SCOREBOARD_H
+
+#include "common.h"
+
+// 점수 파일 형식 (v2): 헤더 뒤에 고정 크기 레코드, 모든 정수는 리틀 엔디언
+//   헤더 32B  : "SWSC" | version u32 | header_size u32 | record_size u32 | created i64 | compacted u32 | crc32 u32
+//   레코드 48B: timestamp i64 | score i32 | name[20] | mode[10] | 예약 2B | crc32 u32
+//   compacted : 마지막 압축 직후 레코드 수
+// 구조체를 그대로 쓰던 v1 파일은 처음 열 때 변환하고 <점수 파일>.v1 로 남겨 둠
+// 쓰기는 모두 <점수 파일>.lock 의 flock 안에서 함 (여러 런처/서버가 같은 파일을 써도 안전)
+#define SCORE_VERSION       2
+#define SCORE_HEADER_SIZE   32
+#define SCORE_RECORD_SIZE   48
+#define SCORE_LEGACY_SUFFIX ".v1"
+#define SCORE_LOCK_SUFFIX   ".lock"
+
+#define SCORE_KEEP_PER_KEY  10      // 압축 후 플레이어/모드별로 남기는 기록 수
+#define SCORE_COMPACT_MIN   1000    // 레코드가 이보다 적으면 압축하지 않음
+
+// 플레이어/모드별 통계: <점수 파일>.stats (판 수, 최고, 평균, 점수 분포 스케치)
+// 분포는 로그 구간 히스토그램 (8 미만은 값 그대로, 그 위는 2 배 구간마다 8 칸, 상대 오차 6.25% 이하)
+#define SCORE_STATS_SUFFIX    ".stats"
+#define SCORE_STATS_VERSION   1
+#define SCORE_STATS_INIT      256   // 해시 테이블 초기 칸 수
+#define SCORE_SKETCH_MAX_BITS 24    // 2^24 이상 점수는 마지막 구간에 셈
+#define SCORE_SKETCH_BUCKETS  (8 + (SCORE_SKETCH_MAX_BITS - 3) * 8)
+
+#define SCORE_INDEX_SIZE    100     // 색인에 보관하는 상위 기록 수
+#define SCORE_INDEX_SUFFIX  ".idx"  // 색인 파일: <점수 파일>.idx
+#define SCORE_INDEX_VERSION 3
+
+// 점수 파일의 정렬된 상위 N 색인
+// saveScore 가 추가할 때마다 갱신하므로 최고 점수/순위 조회는 기록 수와 무관
+typedef struct {
+    char magic[4];              // "SWIX"
+    int version;
+    int entry_size;             // sizeof(ScoreEntry) (다른 빌드가 만든 색인은 다시 만듦)
+    long long data_size;        // 색인에 반영된 점수 파일 크기 (헤더 포함, 바이트)
+    long long data_ino;         // 색인을 만든 점수 파일 (압축으로 교체되면 다시 만듦)
+    long long total;            // 반영된 전체 기록 수
+    long long corrupt;          // 체크섬이 맞지 않아 건너뛴 레코드 수
+    int count;                  // top 에 들어 있는 기록 수
+    ScoreEntry top[SCORE_INDEX_SIZE];   // compareScores 순서
+} ScoreIndex;
+
+typedef struct {
+    long long games;
+    int best;
+    double mean;
+    int p50, p90, p99;          // 스케치 근사값
+} ScoreStats;
+
+// 점수 파일을 읽기 전용으로 매핑한 것 (레코드는 복사하지 않고 제자리에서 읽음)
+typedef struct {
+    const unsigned char* base;
+    size_t size;                // 매핑 크기
+    long long count;            // 완전한 레코드 수 (끝의 잘린 레코드 제외)
+    long long ino;
+    int converted;              // 이번에 v1 파일을 변환했음
+} ScoreMap;
+
+// 점수 파일 매핑 (v1 이면 먼저 변환, 파일이 없으면 빈 매핑)
+int score_map_open(const char* data_path, ScoreMap* map);
+void score_map_close(ScoreMap* map);
+// i 번째 레코드 해석, 체크섬이 맞지 않으면 -1
+int score_map_get(const ScoreMap* map, long long i, ScoreEntry* entry);
+
+// v2 레코드 하나 인코딩/해석 (해석은 체크섬이 맞지 않으면 -1)
+void score_encode_record(unsigned char* p, const ScoreEntry* entry);
+int score_decode_record(const unsigned char* p, ScoreEntry* entry);
+
+// 플레이어/모드 키: 이름/모드 뒤쪽을 0 으로 채워 배열 전체로 해시/비교 (NULL 이면 빈 문자열)
+void score_make_key(ScoreEntry* key, const char* name, const char* mode);
+unsigned int score_key_hash(const ScoreEntry* key);
+int score_key_equal(const ScoreEntry* a, const ScoreEntry* b);
+
+// 레코드를 직접 붙일 fd (변환/생성/끝의 잘린 레코드 정리를 마친 뒤, O_APPEND)
+// 색인은 갱신하지 않으므로 이 파일을 혼자 쓰는 프로세스 (리더보드 WAL) 용
+int score_open_append(const char* data_path);
+
+// v1 파일을 v2 로 변환 (이미 v2 이거나 없으면 0)
+int score_convert(const char* data_path);
+
+// 마지막 압축 뒤로 레코드가 두 배 넘게 늘었는지 (헤더만 읽음)
+int score_compact_needed(const char* data_path);
+// 플레이어/모드별로 상위 keep 개만 남기고 다시 씀, 지운 레코드 수 반환 (실패 시 -1)
+// 고르고 쓰는 동안에는 잠그지 않고, 그 사이 붙은 레코드는 교체 직전에 잠그고 옮김
+long long score_compact(const char* data_path, int keep);
+
+// 점수 내림차순, 같으면 최신 먼저
+int compareScores(const void* a, const void* b);
+
+// 색인을 읽고, 점수 파일이 더 길면 늘어난 부분만 반영
+// 색인이 없거나 맞지 않으면 점수 파일 전체로 다시 만듦 (실패 시 -1)
+int score_index_load(const char* data_path, ScoreIndex* index);
+int score_index_rebuild(const char* data_path, ScoreIndex* index);
+
+// 기록을 점수 파일 끝에 붙이고 색인 갱신
+int score_append(const char* data_path, const ScoreEntry* entry);
+
+long score_best(const char* data_path);
+int score_last(const char* data_path, ScoreEntry* entry);   // 마지막으로 붙은 기록
+
+// 통계 조회 (판 수와 무관하게 해시 한 번 + 고정 크기 히스토그램), name 이 NULL/"" 이면 모드 전체
+// 기록이 없으면 -1
+int score_stats(const char* data_path, const char* name, const char* mode, ScoreStats* out);
+// mode 의 모든 판 중 score 보다 낮았던 비율 (0~1, 기록이 없으면 -1)
+double score_stats_beaten(const char* data_path, const char* mode, int score);
+// 상위 max 개 (max <= SCORE_INDEX_SIZE) 를 순서대로 복사, 복사한 개수 반환
+int score_top(const char* data_path, ScoreEntry* out, int max);
+
+#endif
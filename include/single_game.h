@@ -0,0 +1,20 @@
+#ifndef SINGLE_GAME_H
+#define SINGLE_GAME_H
+
+#include <stdio.h>
+
+// 싱글 플레이 한 판의 결과
+typedef struct {
+    int score;
+    int level;
+    int frames;             // 진행한 틱 수
+    int quit;               // q 로 중단했으면 1
+} SingleResult;
+
+// 이미 켜져 있는 ncurses 화면 위에서 싱글 플레이 한 판 (게임 오버 화면에서 키를 누를 때까지)
+// initscr/endwin 은 호출한 쪽 몫이고, 색상 쌍은 게임용으로 바뀌므로 돌아온 뒤 다시 설정해야 함
+void single_game_run(SingleResult* result);
+// 마지막 판의 키 입력 지연 통계
+void single_game_report(FILE* out);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdatomic.h>
+#include "common.h"
+
+// 게임 상태 삼중 버퍼 (생산자 1, 소비자 1, 락 없음)
+// 생산자는 back 에 완성된 상태를 쓰고 publish 로 교체,
+// 소비자는 acquire 로 가장 최근 상태를 front 로 가져와 락 없이 읽음
+typedef struct {
+    GameState buf[3];
+    atomic_uint latest;         // 마지막으로 발행된 버퍼 인덱스 | SNAPSHOT_FRESH
+    unsigned int back;          // 생산자 전용
+    unsigned int front;         // 소비자 전용
+
+    long long published;        // 발행 횟수 (생산자)
+    long long acquired;         // 새 상태를 가져간 횟수 (소비자)
+} SnapshotBuffer;
+
+void snapshot_init(SnapshotBuffer* sb);
+GameState* snapshot_back(SnapshotBuffer* sb);
+void snapshot_publish(SnapshotBuffer* sb);
+const GameState* snapshot_acquire(SnapshotBuffer* sb, int* fresh);
+
+#endif
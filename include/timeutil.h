@@ -0,0 +1,9 @@
+#ifndef TIMEUTIL_H
+#define TIMEUTIL_H
+
+// 단조 증가 시계 (나노초)
+long long now_ns(void);
+// 벽시계 (나노초, 로그/트레이스처럼 다른 프로세스 기록과 맞춰 보는 타임스탬프용)
+long long realtime_ns(void);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "timeutil.h"
+
+#define TRACE_EVENTS 16384      // 스레드별 보관 이벤트 수 (오래된 것부터 덮어씀)
+#define TRACE_MAX_THREADS 16
+
+// Chrome trace (chrome://tracing, Perfetto) 이벤트
+typedef struct {
+    const char* name;           // 정적 문자열만 사용
+    long long ts_ns;            // CLOCK_REALTIME (서버/클라이언트 타임라인 정렬용)
+    long long dur_ns;           // 구간 이벤트 길이 ('X')
+    int arg;
+    char phase;                 // 'X': 구간, 'i': 순간
+} TraceEvent;
+
+// 트레이서가 켜져 있는지 (꺼져 있으면 기록 비용 없음)
+extern int trace_enabled;
+
+// 환경 변수 SPACEWAR_TRACE=<경로 접두사> 가 있으면 켬
+// 출력 파일: <접두사>.<process>.<pid>.json
+void trace_init_env(const char* process);
+// 현재 스레드 이름 지정 (처음 기록 전에 호출)
+void trace_thread(const char* name);
+
+static inline long long trace_begin(void) {
+    return trace_enabled ? realtime_ns() : 0;
+}
+
+void trace_end(const char* name, long long start, int arg);
+void trace_instant(const char* name, int arg);
+
+void trace_poll(void);          // SIGUSR2 를 받았으면 파일로 기록
+int trace_flush(void);
+
+#endif
@@ -3,7 +3,31 @@
 
 #include "common.h"
 
+// 터미널 출력 품질 단계 (출력 예산을 넘으면 한 단계씩 낮춤)
+#define VIEW_QUALITY_RATE    1  // 그리기 주기를 틱 주기 이하로
+#define VIEW_QUALITY_PLAIN   2  // 깜빡임/반전/굵게 속성 생략
+#define VIEW_QUALITY_OUTLINE 3  // 레드존은 테두리만, 그리기 주기 절반
+#define VIEW_QUALITY_MIN     VIEW_QUALITY_OUTLINE
+
+// 터미널 출력 통계
+typedef struct {
+    long long total_bytes;      // 누적 출력 바이트
+    long long frames;           // view_present 호출 수
+    long long bytes_per_sec;    // 최근 1초
+    long long bytes_per_frame;  // 최근 1초 평균
+    long long drain_us;         // 최근 1초 평균 tcdrain 시간
+    long long budget;           // 초당 출력 예산 (SPACEWAR_TTY_BUDGET)
+    long long degrades;         // 품질을 낮춘 횟수
+    int quality;                // 현재 단계 (0: 전체 효과)
+} ViewOutput;
+
 void view_init();
+// 이미 켜진 ncurses 화면을 게임용 (raw, non-blocking, 게임 색상) 으로 설정
+void view_setup(void);
+void view_present(void);
+const ViewOutput* view_output(void);
+long long view_frame_interval_us(long long base_us, long long tick_ns);  // tick_ns: 설정된 틱 주기
+void view_invalidate(void);
 void draw_game(const GameState* game_state, int my_player_id, int frame);
 void gameOverScreen(int winner_id, int my_player_id, int score);
 void singleGameOverScreen(int score, int level);
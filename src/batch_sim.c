@@ -0,0 +1,402 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include "game_logic.h"
+#include "item.h"
+#include "common.h"
+#include "lagcomp.h"
+
+// 헤드리스 배치 시뮬레이터
+// 서로 다른 시드의 게임 수천 판을 봇 입력으로 스레드 풀에서 최대 속도로 돌리고
+// 생존 시간, 피격 원인, 화살 생성 실패를 집계한다.
+
+#define MAX_SWEEP_VALUES 32
+#define DEFAULT_MATCHES  1000
+#define DEFAULT_MAX_SECONDS (60 * 10)  // 10분
+
+typedef enum {
+    BOT_IDLE,    // 가만히 있기
+    BOT_RANDOM,  // 무작위 이동
+    BOT_DODGE    // 화살/레드존 회피
+} BotType;
+
+// 스윕 가능한 설정 항목
+typedef struct {
+    const char* name;
+    size_t offset;
+} ConfigParam;
+
+static const ConfigParam config_params[] = {
+    { "tick_hz",                offsetof(GameConfig, tick_hz) },
+    { "level_ms",               offsetof(GameConfig, level_ms) },
+    { "spawn_rate",             offsetof(GameConfig, spawn_rate) },
+    { "spawn_rate_per_level",   offsetof(GameConfig, spawn_rate_per_level) },
+    { "special_rate",           offsetof(GameConfig, special_rate) },
+    { "special_rate_per_level", offsetof(GameConfig, special_rate_per_level) },
+    { "arrow_speed",            offsetof(GameConfig, arrow_speed) },
+    { "damage_cooldown_ms",     offsetof(GameConfig, damage_cooldown_ms) },
+    { "redzone_lifetime_ms",    offsetof(GameConfig, redzone_lifetime_ms) },
+    { "invincible_ms",          offsetof(GameConfig, invincible_ms) },
+    { "slow_ms",                offsetof(GameConfig, slow_ms) },
+    { "wave_interval_ms",       offsetof(GameConfig, wave_interval_ms) },
+    { "wave_ms",                offsetof(GameConfig, wave_ms) },
+    { "redzone_interval_ms",    offsetof(GameConfig, redzone_interval_ms) },
+    { "attack_interval_ms",     offsetof(GameConfig, attack_interval_ms) },
+};
+#define CONFIG_PARAM_COUNT (int)(sizeof(config_params) / sizeof(config_params[0]))
+
+// 한 판의 결과
+typedef struct {
+    int time_ms;                // 생존 시간 (멀티는 게임 길이)
+    int winner;                 // 멀티: 승자 ID (-1 무승부), 싱글: 0
+    GameStats stats;
+} MatchResult;
+
+// 시뮬레이션 작업 전체
+typedef struct {
+    int matches;                // 설정 값 하나당 판 수
+    int max_seconds;
+    bool multiplay;
+    BotType bot;
+    unsigned int base_seed;
+
+    int lag_ms;                 // 봇 화면 지연 (이만큼 지난 상태를 보고 정한 입력을 바로 적용)
+    bool lagcomp;               // 서버 랙 보정 적용
+
+    const ConfigParam* param;   // 스윕 대상 (NULL 이면 기본 설정만)
+    int values[MAX_SWEEP_VALUES];
+    int value_count;
+
+    MatchResult* results;       // [value_count * matches]
+    int total_jobs;
+    int next_job;               // 워커들이 원자적으로 가져감
+} BatchJob;
+
+static void set_param(GameConfig* config, const ConfigParam* param, int value) {
+    *(int*)((char*)config + param->offset) = value;
+}
+
+static int get_param(const GameConfig* config, const ConfigParam* param) {
+    return *(const int*)((const char*)config + param->offset);
+}
+
+// 랙 보정 판정은 스레드마다 자기 게임의 기록을 씀
+static __thread LagComp sim_lagcomp;
+static __thread GameState sim_views[LAGCOMP_HISTORY];  // 지연된 봇이 보는 화면
+
+static void sim_collisions(GameState* state, int width, int height) {
+    (void)width;
+    (void)height;
+    lagcomp_collisions(&sim_lagcomp, state);
+}
+
+// (x, y) 칸의 위험도: 다음 1~2 프레임 안에 화살이 오거나 레드존 안이면 높음
+static int danger_at(const GameState* state, int x, int y) {
+    int danger = 0;
+
+    for (int i = 0; i < MAX_ARROWS; i++) {
+        const Arrow* a = &state->arrow[i];
+        if (!a->active) continue;
+        if (a->x + a->dx == x && a->y + a->dy == y) danger += 4;
+        else if (a->x + 2 * a->dx == x && a->y + 2 * a->dy == y) danger += 1;
+    }
+
+    for (int i = 0; i < MAX_REDZONES; i++) {
+        const RedZone* r = &state->redzone[i];
+        if (r->active && x >= r->x && x < r->x + r->width && y >= r->y && y < r->y + r->height) {
+            danger += 8;
+        }
+    }
+    return danger;
+}
+
+// 봇 입력 한 번 적용 (single_play 의 키 입력과 같은 위치에서 호출)
+// 위험은 view (봇 화면, 지연이 있으면 지난 틱) 기준으로 판단
+static void bot_input(GameState* state, const GameState* view, int id, BotType bot, unsigned int* bot_seed) {
+    static const int moves[5][2] = {{0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    Player* p = &state->player[id];
+
+    if (bot == BOT_IDLE) return;
+
+    if (bot == BOT_RANDOM) {
+        int m = rand_r(bot_seed) % 5;
+        move_player(p, moves[m][0], moves[m][1]);
+        return;
+    }
+
+    int best = 0;
+    int best_danger = -1;
+    int start = rand_r(bot_seed) % 5; // 동점일 때 방향 편향 방지
+    for (int k = 0; k < 5; k++) {
+        int m = (start + k) % 5;
+        int nx = p->x + moves[m][0];
+        int ny = p->y + moves[m][1];
+        if (nx < 1 || nx > GAME_WIDTH - 2 || ny < 1 || ny > GAME_HEIGHT - 2) continue;
+
+        int d = danger_at(view, nx, ny);
+        if (m == 0) d = d * 2 - 1; // 동점이면 제자리 유지
+        if (best_danger < 0 || d < best_danger) {
+            best_danger = d;
+            best = m;
+        }
+    }
+    move_player(p, moves[best][0], moves[best][1]);
+
+    if (p->lives < 3) heal_item(p);
+    if (best_danger > 0 && !p->invincible) invincible_item(p, &state->config);
+    if (view->special_wave > 0) slow_item(p, &state->config);
+}
+
+static void run_match(const BatchJob* job, int job_index, MatchResult* out) {
+    GameState state;
+    int value_index = job_index / job->matches;
+    unsigned int seed = job->base_seed + (unsigned int)job_index;
+    unsigned int bot_seed = seed * 2654435761u;
+
+    init_game(&state, job->multiplay);
+    if (job->param) {
+        set_param(&state.config, job->param, job->values[value_index]);
+    }
+    seed_game(&state, seed);
+
+    int players = job->multiplay ? 2 : 1;
+    for (int i = 0; i < players; i++) {
+        state.player[i].connected = 1;
+    }
+
+    int lag = (int)((long long)job->lag_ms * state.config.tick_hz / 1000);
+    if (lag > LAGCOMP_HISTORY - 1) lag = LAGCOMP_HISTORY - 1;
+    if (job->lagcomp) lagcomp_init(&sim_lagcomp, LAGCOMP_DEFAULT_MS, state.config.tick_hz);
+
+    // 봇은 틱 속도와 관계없이 기본 틱 속도(TICK_HZ)로 한 번씩 움직임
+    int bot_step = -1;
+    while (game_elapsed_ms(&state) < job->max_seconds * 1000LL) {
+        int alive = 0;
+        for (int i = 0; i < players; i++) {
+            if (state.player[i].lives > 0) alive++;
+        }
+        if (alive == 0 || (job->multiplay && alive == 1)) break;
+
+        const GameState* view = &state;
+        if (lag > 0) {
+            memcpy(&sim_views[state.frame % LAGCOMP_HISTORY], &state, sizeof(GameState));
+            int seen = state.frame >= lag ? state.frame - lag : 0;
+            view = &sim_views[seen % LAGCOMP_HISTORY];
+        }
+
+        int step = (int)((long long)state.frame * TICK_HZ / state.config.tick_hz);
+        for (int i = 0; i < players && step != bot_step; i++) {
+            if (state.player[i].lives > 0) {
+                bot_input(&state, view, i, job->bot, &bot_seed);
+                if (job->lagcomp) lagcomp_input(&sim_lagcomp, i, view->frame, state.frame);
+            }
+        }
+        bot_step = step;
+        update_game(&state, GAME_WIDTH, GAME_HEIGHT);
+        update_events(&state, GAME_WIDTH, GAME_HEIGHT);
+    }
+
+    out->time_ms = (int)game_elapsed_ms(&state);
+    out->winner = 0;
+    if (job->multiplay) {
+        out->winner = -1;
+        if (state.player[0].lives > 0 && state.player[1].lives <= 0) out->winner = 0;
+        if (state.player[1].lives > 0 && state.player[0].lives <= 0) out->winner = 1;
+    }
+    out->stats = state.stats;
+}
+
+static void* worker(void* arg) {
+    BatchJob* job = (BatchJob*)arg;
+
+    while (1) {
+        int idx = __atomic_fetch_add(&job->next_job, 1, __ATOMIC_RELAXED);
+        if (idx >= job->total_jobs) break;
+        run_match(job, idx, &job->results[idx]);
+    }
+    return NULL;
+}
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static void print_report(const BatchJob* job, double elapsed) {
+    static const char* source_names[DAMAGE_SOURCES] = { "arrow", "special", "attack", "redzone" };
+    int* times = malloc(sizeof(int) * job->matches);
+    if (!times) return;
+
+    printf("%-22s %7s %8s %7s %7s %7s",
+           job->param ? job->param->name : "config", "matches", "mean(s)", "p10", "p50", "p90");
+    for (int s = 0; s < DAMAGE_SOURCES; s++) printf(" %8s", source_names[s]);
+    printf(" %8s %8s", "spawn/m", "drop/m");
+    if (job->multiplay) printf(" %6s %6s %6s", "p1win", "p2win", "draw");
+    printf("\n");
+
+    for (int v = 0; v < job->value_count; v++) {
+        const MatchResult* r = &job->results[v * job->matches];
+        long long sum_ms = 0;
+        long long damage[DAMAGE_SOURCES] = {0};
+        long long total_damage = 0;
+        long long spawned = 0, drops = 0;
+        int wins[2] = {0, 0}, draws = 0;
+
+        for (int m = 0; m < job->matches; m++) {
+            times[m] = r[m].time_ms;
+            sum_ms += r[m].time_ms;
+            for (int s = 0; s < DAMAGE_SOURCES; s++) {
+                damage[s] += r[m].stats.damage[s];
+                total_damage += r[m].stats.damage[s];
+            }
+            spawned += r[m].stats.arrows_spawned;
+            drops += r[m].stats.spawn_drops;
+            if (r[m].winner >= 0) wins[r[m].winner]++;
+            else draws++;
+        }
+        qsort(times, job->matches, sizeof(int), compare_int);
+
+        char label[32];
+        if (job->param) snprintf(label, sizeof(label), "%d", job->values[v]);
+        else snprintf(label, sizeof(label), "default");
+
+        printf("%-22s %7d %8.1f %7.1f %7.1f %7.1f", label, job->matches,
+               sum_ms / 1000.0 / job->matches,
+               times[job->matches / 10] / 1000.0,
+               times[job->matches / 2] / 1000.0,
+               times[job->matches * 9 / 10] / 1000.0);
+        for (int s = 0; s < DAMAGE_SOURCES; s++) {
+            printf(" %7.1f%%", total_damage ? 100.0 * damage[s] / total_damage : 0.0);
+        }
+        printf(" %8.1f %8.2f", (double)spawned / job->matches, (double)drops / job->matches);
+        if (job->multiplay) printf(" %6d %6d %6d", wins[0], wins[1], draws);
+        printf("\n");
+    }
+
+    printf("\n%d matches in %.2fs (%.0f matches/s)\n",
+           job->total_jobs, elapsed, elapsed > 0 ? job->total_jobs / elapsed : 0.0);
+    free(times);
+}
+
+static int parse_sweep(BatchJob* job, const char* spec) {
+    const char* eq = strchr(spec, '=');
+    if (!eq) return -1;
+
+    for (int i = 0; i < CONFIG_PARAM_COUNT; i++) {
+        if (strlen(config_params[i].name) == (size_t)(eq - spec) &&
+            strncmp(config_params[i].name, spec, eq - spec) == 0) {
+            job->param = &config_params[i];
+        }
+    }
+    if (!job->param) return -1;
+
+    job->value_count = 0;
+    const char* p = eq + 1;
+    while (*p && job->value_count < MAX_SWEEP_VALUES) {
+        char* end;
+        long v = strtol(p, &end, 10);
+        if (end == p || v <= 0) return -1;
+        job->values[job->value_count++] = (int)v;
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return -1;
+    }
+    return job->value_count > 0 ? 0 : -1;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "사용법: %s [-n 판수] [-j 스레드] [-s 시드] [-f 최대초] [-b idle|random|dodge] [-m] [-L 지연ms] [-C] [-p 항목=값,값,...]\n"
+        "  -m : 2인 대전 (봇 vs 봇)\n"
+        "  -L : 봇 화면 지연 (지연ms 전 상태를 보고 움직임, 입력 자체는 늦추지 않음)\n"
+        "  -C : 서버 랙 보정 (피격을 봇이 보던 틱 기준으로 판정)\n"
+        "  -p : 설정 항목 스윕. 항목:", prog);
+    for (int i = 0; i < CONFIG_PARAM_COUNT; i++) fprintf(stderr, " %s", config_params[i].name);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char* argv[]) {
+    BatchJob job;
+    memset(&job, 0, sizeof(job));
+    job.matches = DEFAULT_MATCHES;
+    job.max_seconds = DEFAULT_MAX_SECONDS;
+    job.bot = BOT_DODGE;
+    job.base_seed = (unsigned int)time(NULL);
+
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:j:s:f:b:mL:Cp:h")) != -1) {
+        switch (opt) {
+            case 'n': job.matches = atoi(optarg); break;
+            case 'j': threads = atoi(optarg); break;
+            case 's': job.base_seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'f': job.max_seconds = atoi(optarg); break;
+            case 'm': job.multiplay = true; break;
+            case 'L': job.lag_ms = atoi(optarg); break;
+            case 'C': job.lagcomp = true; break;
+            case 'b':
+                if (strcmp(optarg, "idle") == 0) job.bot = BOT_IDLE;
+                else if (strcmp(optarg, "random") == 0) job.bot = BOT_RANDOM;
+                else if (strcmp(optarg, "dodge") == 0) job.bot = BOT_DODGE;
+                else { usage(argv[0]); return 1; }
+                break;
+            case 'p':
+                if (parse_sweep(&job, optarg) != 0) {
+                    fprintf(stderr, "잘못된 스윕 지정: %s\n", optarg);
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (job.matches <= 0 || job.max_seconds <= 0 || job.lag_ms < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads < 1) threads = 1;
+    if (!job.param) job.value_count = 1;
+
+    job.total_jobs = job.value_count * job.matches;
+    job.results = calloc(job.total_jobs, sizeof(MatchResult));
+    pthread_t* pool = malloc(sizeof(pthread_t) * threads);
+    if (!job.results || !pool) {
+        perror("메모리 할당 실패");
+        return 1;
+    }
+
+    if (job.param) {
+        GameConfig defaults;
+        default_config(&defaults);
+        printf("sweep %s (default %d), ", job.param->name, get_param(&defaults, job.param));
+    }
+    printf("%d threads, seed %u, %s, lag %dms%s\n\n", threads, job.base_seed, job.multiplay ? "2P" : "1P",
+           job.lag_ms, job.lagcomp ? " (lag compensated)" : "");
+    if (job.lagcomp) set_collision_handler(sim_collisions);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&pool[i], NULL, worker, &job);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(pool[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    print_report(&job, elapsed);
+
+    free(pool);
+    free(job.results);
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <sys/socket.h>
@@ -13,10 +14,43 @@
 #include "common.h"
 #include "game_logic.h"
 #include "view.h"
+#include "rollback.h"
+#include "lockstep.h"
+#include "net.h"
+#include "ring.h"
+#include "snapshot.h"
+#include "timeutil.h"
+#include "trace.h"
+#include "logger.h"
+#include "input.h"
+
+#define REMOTE_INPUT_QUEUE 256  // 락스텝 상대 입력 큐 크기
+#define RENDER_USEC 16667       // 목표 그리기 주기 (최대 60fps, 바뀐 게 있을 때만)
+#define PACER_WINDOW 512        // 프레임 간격 통계용 최근 샘플 수
+
+// 화면 그리기 통계
+typedef struct {
+    long long frames;
+    long long skipped;          // 그리기 전에 상태가 여러 번 바뀌어 건너뛴 프레임
+    long long late_ticks;       // 한 틱 넘게 밀려 일정을 다시 맞춘 횟수
+    long long cost_avg_ns;      // 그리기 + refresh 비용 (EWMA)
+    long long cost_max_ns;
+    long long last_frame_ns;
+    long long intervals[PACER_WINDOW];  // 최근 프레임 간격
+} FramePacer;
 
 // 전역 변수
 int server_sock;
-GameState game_state;
+GameState game_state;       // 화면에 그리는 예측 상태 (게임 중에는 메인 스레드 전용)
+GameState preview_state;    // 틱 전에 미리 옮긴 내 위치로 그릴 때 사용
+FramePacer pacer;
+InputQueue keys;            // 읽었지만 아직 틱에 적용하지 않은 키
+SnapshotBuffer snapshots;   // 서버 확정 틱 상태 (수신 스레드 -> 메인 스레드, 락 없음)
+Ring remote_inputs;         // 락스텝 상대 입력 (수신 스레드 -> 메인 스레드, 락 없음)
+int playing = 0;            // 게임 루프 진행 중 (game_state 소유권이 메인 스레드로 넘어감)
+Rollback rollback;
+Lockstep lockstep;
+int lockstep_started = 0;   // LOCKSTEP_START 수신 후에는 입력 프레임만 오감
 int id = -1;
 int game_over = 0;
 int winner = -1;
@@ -24,28 +58,211 @@ pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t state_cond = PTHREAD_COND_INITIALIZER;
 volatile int game_running = 1;
 
+// 서버로 보내는 쪽 (메인 스레드 입력 + 하트비트 스레드)
+pthread_mutex_t send_mutex = PTHREAD_MUTEX_INITIALIZER;
+long long last_send_ns = 0;         // 마지막 전송 시각 (send_mutex)
+volatile int heartbeat_running = 0;
+int server_lockstep = 0;            // 서버가 락스텝 모드면 처음부터 입력 프레임 형식으로 보냄
+
+// 측정값: state_mutex 대기, 락 밖으로 옮긴 화면 그리기
+long long lock_waits = 0, lock_wait_ns = 0, lock_wait_max_ns = 0;
+long long draws = 0, draw_ns = 0, draw_max_ns = 0;
+
+// state_mutex 획득 (기다린 경우 대기 시간 기록)
+static void lock_state(void) {
+    if (pthread_mutex_trylock(&state_mutex) == 0) return;
+
+    long long start = now_ns();
+    long long t = trace_begin();
+    pthread_mutex_lock(&state_mutex);
+    long long waited = now_ns() - start;
+    trace_end("lock_wait", t, 0);
+
+    lock_waits++;
+    lock_wait_ns += waited;
+    if (waited > lock_wait_max_ns) lock_wait_max_ns = waited;
+}
+
+// 화면 그리기 (메인 스레드 소유 상태만 읽으므로 락 불필요), refresh 까지 걸린 시간 반환
+static long long render(const GameState* state, int frame) {
+    long long start = now_ns();
+    long long t = trace_begin();
+    draw_game(state, id, frame);
+    trace_end("draw_game", t, frame);
+    long long elapsed = now_ns() - start;
+
+    draws++;
+    draw_ns += elapsed;
+    if (elapsed > draw_max_ns) draw_max_ns = elapsed;
+
+    t = trace_begin();
+    view_present();
+    trace_end("refresh", t, frame);
+    return now_ns() - start;
+}
+
+// 프레임 하나를 그린 뒤 통계 갱신
+static void pacer_frame(FramePacer* fp, long long done, long long cost) {
+    if (fp->last_frame_ns > 0) {
+        fp->intervals[fp->frames % PACER_WINDOW] = done - fp->last_frame_ns;
+        fp->frames++;
+    }
+    fp->last_frame_ns = done;
+
+    fp->cost_avg_ns = fp->cost_avg_ns ? (fp->cost_avg_ns * 7 + cost) / 8 : cost;
+    if (cost > fp->cost_max_ns) fp->cost_max_ns = cost;
+
+    input_shown(&keys, done);
+}
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static void pacer_report(FramePacer* fp, FILE* out) {
+    int n = fp->frames < PACER_WINDOW ? (int)fp->frames : PACER_WINDOW;
+    long long p50 = 0, p99 = 0;
+    if (n > 0) {
+        long long sorted[PACER_WINDOW];
+        memcpy(sorted, fp->intervals, n * sizeof(long long));
+        qsort(sorted, n, sizeof(long long), compare_ll);
+        p50 = sorted[n / 2];
+        p99 = sorted[(n * 99) / 100];
+    }
+    fprintf(out, "[frame] frames=%lld skipped=%lld late_ticks=%lld interval_p50=%lldms p99=%lldms "
+                 "cost_avg=%lldus max=%lldus\n",
+            fp->frames, fp->skipped, fp->late_ticks, p50 / 1000000, p99 / 1000000,
+            fp->cost_avg_ns / 1000, fp->cost_max_ns / 1000);
+}
+
+// 서버로 패킷 전송 (입력마다 번호를 붙여 서버가 STATE_UPDATE 의 ack_trace 로 돌려줌)
+static void send_to_server(Packet* packet) {
+    static int next_input_id = 0;
+    packet->input_id = ++next_input_id;
+    packet->sent_ns = now_ns();
+
+    long long t = trace_begin();
+    pthread_mutex_lock(&send_mutex);
+    net_write_full(server_sock, packet, sizeof(Packet));
+    last_send_ns = now_ns();
+    pthread_mutex_unlock(&send_mutex);
+    trace_end(packet_name(packet->type), t, packet->frame);
+}
+
+static void send_lockstep(const LockstepInput* input) {
+    pthread_mutex_lock(&send_mutex);
+    lockstep_send(server_sock, input);
+    last_send_ns = now_ns();
+    pthread_mutex_unlock(&send_mutex);
+}
+
+// 보낼 입력이 없는 동안 (대기, 카운트다운, 결과 화면) 서버가 연결을 끊지 않도록
+// NET_HEARTBEAT_MS 마다 하트비트 전송
+static void* heartbeat_thread(void* arg) {
+    (void)arg;
+    static Packet packet;
+
+    while (heartbeat_running) {
+        usleep(NET_HEARTBEAT_MS * 1000 / 5);
+
+        pthread_mutex_lock(&send_mutex);
+        if (now_ns() - last_send_ns >= NET_HEARTBEAT_MS * 1000000LL) {
+            if (server_lockstep) {
+                LockstepInput input;
+                memset(&input, 0, sizeof(input));
+                input.id = (uint8_t)id;
+                input.item = LOCKSTEP_HEARTBEAT;
+                lockstep_send(server_sock, &input);
+            } else {
+                memset(&packet, 0, sizeof(packet));
+                packet.type = HEARTBEAT;
+                packet.id = id;
+                net_write_full(server_sock, &packet, sizeof(packet));
+            }
+            last_send_ns = now_ns();
+        }
+        pthread_mutex_unlock(&send_mutex);
+    }
+    return NULL;
+}
+
+static void start_heartbeat(pthread_t* thread) {
+    last_send_ns = now_ns();
+    heartbeat_running = 1;
+    pthread_create(thread, NULL, heartbeat_thread, NULL);
+}
+
+static void stop_heartbeat(pthread_t thread) {
+    heartbeat_running = 0;
+    pthread_join(thread, NULL);
+}
+
+// 락스텝 입력 프레임 수신 (상대 입력 또는 종료 알림)
+static int receive_lockstep(void) {
+    LockstepInput input;
+    if (lockstep_recv(server_sock, &input) != 0) return -1;
+    trace_instant(packet_name(PACKET_TYPES), input.frame);
+
+    if (input.item == LOCKSTEP_END) {
+        lock_state();
+        game_over = 1;
+        winner = (input.id == LOCKSTEP_END) ? -1 : input.id;
+        game_running = 0;
+        pthread_cond_signal(&state_cond);
+        pthread_mutex_unlock(&state_mutex);
+        return 0;
+    }
+
+    // 메인 스레드가 틱마다 비우므로 가득 차는 일은 드묾 (입력은 버릴 수 없으니 대기)
+    while (ring_push(&remote_inputs, &input) != 0 && game_running) {
+        usleep(1000);
+    }
+    return 0;
+}
+
 // 서버 수신 스레드
 void* receive_thread(void* arg) {
     (void)arg;
     Packet packet;
+    trace_thread("recv");
+    log_thread("recv");
     
     while (game_running) {
-        int recv_size = recv(server_sock, &packet, sizeof(Packet), 0);
+        int failed;
+        if (lockstep_started) {
+            failed = receive_lockstep() != 0;
+            if (!failed) continue;
+        } else {
+            failed = net_read_full(server_sock, &packet, sizeof(Packet)) != 0;
+        }
         
-        if (recv_size <= 0) {
-            pthread_mutex_lock(&state_mutex);
+        if (failed) {
+            if (!game_over) log_warn("서버 연결 끊김 (프레임 %d)", game_state.frame);
+            lock_state();
             game_running = 0;
             pthread_cond_broadcast(&state_cond);  // 모든 대기 스레드 깨우기
             pthread_mutex_unlock(&state_mutex);
             break;
         }
+        trace_instant(packet_name(packet.type), packet.frame);
+
+        // 매 틱 오는 확정 상태는 back 버퍼에 채운 뒤 교체만 함 (락 없음)
+        if (packet.type == STATE_UPDATE) {
+            memcpy(snapshot_back(&snapshots), &packet.game_state, sizeof(GameState));
+            snapshot_publish(&snapshots);
+            continue;
+        }
         
-        pthread_mutex_lock(&state_mutex);
+        lock_state();
         
         switch (packet.type) {
             case INITIAL_STATE:
                 id = packet.id;
+                server_lockstep = packet.game_state.lockstep;
                 memcpy(&game_state, &packet.game_state, sizeof(GameState));
+                log_info("플레이어 %d 로 접속%s", id, server_lockstep ? " (lockstep)" : "");
                 pthread_cond_signal(&state_cond);  // ID 할당 알림
                 break;
             case ARROW_UPDATE:
@@ -54,8 +271,15 @@ void* receive_thread(void* arg) {
             case REDZONE_UPDATE:
                 memcpy(game_state.redzone, packet.redzones, sizeof(game_state.redzone));
                 break;
+            case LOCKSTEP_START:
+                // 합의된 시드/설정으로 각자 시뮬레이션 시작
+                memcpy(&game_state, &packet.game_state, sizeof(GameState));
+                lockstep_init(&lockstep, LOCKSTEP_DELAY);
+                lockstep_started = 1;
+                pthread_cond_signal(&state_cond);
+                break;
             case PLAYER_STATUS:
-                if (packet.id >= 0 && packet.id < MAX_PLAYERS) {
+                if (!playing && packet.id >= 0 && packet.id < MAX_PLAYERS) {
                     memcpy(&game_state.player[packet.id], 
                            &packet.player, sizeof(Player));
                     pthread_cond_signal(&state_cond);  // 플레이어 상태 변경 알림
@@ -64,6 +288,7 @@ void* receive_thread(void* arg) {
             case GAME_OVER:
                 game_over = 1;
                 winner = packet.id;
+                log_info("게임 종료, 승자 %d (프레임 %d)", winner, game_state.frame);
                 game_running = 0;
                 pthread_cond_signal(&state_cond);
                 break;
@@ -77,6 +302,116 @@ void* receive_thread(void* arg) {
 }
 
 
+// 방향키 한 번만큼 이동
+static void move_with_key(Player* player, int key) {
+    if (key == KEY_LEFT) move_player(player, -1, 0);
+    else if (key == KEY_RIGHT) move_player(player, 1, 0);
+    else if (key == KEY_UP) move_player(player, 0, -1);
+    else if (key == KEY_DOWN) move_player(player, 0, 1);
+}
+
+static int is_move_key(int key) {
+    return key == KEY_LEFT || key == KEY_RIGHT || key == KEY_UP || key == KEY_DOWN;
+}
+
+static int is_item_key(int key) {
+    return key >= '1' && key <= '3';
+}
+
+// 이번 틱에 적용할 키를 도착 순서대로 하나 꺼냄 (더 없으면 ERR)
+// 이동은 max_moves 개, 아이템은 틱당 하나까지 꺼내고 그 뒤 키는 큐에 남겨 다음 틱에 적용
+static int pop_tick_key(int* moves, int* items, int max_moves) {
+    const KeyEvent* ev;
+    while ((ev = input_peek(&keys, 0)) != NULL) {
+        int key = ev->key;
+        if (is_move_key(key) && *moves >= max_moves) return ERR;
+        if (is_item_key(key) && *items >= 1) return ERR;
+
+        KeyEvent taken;
+        input_pop(&keys, &taken);
+        if (key == 'q' || key == 'Q') {
+            game_running = 0;
+            return ERR;
+        }
+        if (is_move_key(key)) {
+            (*moves)++;
+            return key;
+        }
+        if (is_item_key(key)) {
+            (*items)++;
+            return key;
+        }
+    }
+    return ERR;
+}
+
+// 락스텝 게임 루프: 모든 플레이어의 입력이 모인 프레임만 진행
+static void lockstep_loop(void) {
+    int frame = 0;  // 로컬 틱 수 (실시간 진행 속도 기준)
+
+    lock_state();
+    while (!lockstep_started && game_running) {
+        pthread_cond_wait(&state_cond, &state_mutex);
+    }
+    long long tick_ns = config_tick_ns(&game_state.config);  // 서버와 같은 틱 속도
+    pthread_mutex_unlock(&state_mutex);
+
+    while (game_running && !game_over) {
+        long long tick = trace_begin();
+        input_drain(&keys);
+
+        // 락스텝 프레임에는 이동 한 칸만 담을 수 있으므로 남은 키는 다음 프레임으로 넘김
+        LockstepInput input;
+        memset(&input, 0, sizeof(input));
+        input.id = (uint8_t)id;
+        int moves = 0, items = 0, key;
+        while ((key = pop_tick_key(&moves, &items, 1)) != ERR) {
+            if (key == KEY_LEFT) input.dx = -1;
+            else if (key == KEY_RIGHT) input.dx = 1;
+            else if (key == KEY_UP) input.dy = -1;
+            else if (key == KEY_DOWN) input.dy = 1;
+            else input.item = (uint8_t)(key - '0');
+        }
+
+        LockstepInput remote;
+        while (ring_pop(&remote_inputs, &remote) == 0) {
+            lockstep_add(&lockstep, &remote, game_state.frame);
+        }
+
+        // 밀려 있으면 한 번에 2프레임까지 따라잡음
+        int steps = 0;
+        while (steps < 2 && game_state.frame <= frame && lockstep_ready(&lockstep, &game_state)) {
+            // 내 입력은 지연 버퍼만큼 뒤 프레임으로 예약
+            input.frame = game_state.frame + lockstep.delay;
+            lockstep_add(&lockstep, &input, game_state.frame);
+            long long t = trace_begin();
+            send_lockstep(&input);
+            trace_end(packet_name(PACKET_TYPES), t, input.frame);
+            input.dx = input.dy = 0;
+            input.item = 0;
+
+            t = trace_begin();
+            lockstep_advance(&lockstep, &game_state);
+            trace_end("lockstep_advance", t, game_state.frame);
+            steps++;
+        }
+        if (steps == 0) lockstep.stalls++;
+
+        pacer_frame(&pacer, now_ns(), render(&game_state, frame));
+
+        trace_end("tick", tick, frame);
+        trace_poll();
+        frame++;
+
+        // 다음 틱까지 키가 들어오는 대로 읽어 둠 (도착 시각 기록)
+        long long deadline = now_ns() + tick_ns;
+        long long wait;
+        while ((wait = deadline - now_ns()) > 0) {
+            if (input_wait(wait / 1000)) input_drain(&keys);
+        }
+    }
+}
+
 int main(int argc, char* argv[]) {
 
     if (argc != 2) {
@@ -84,6 +419,17 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     view_init();
+    // SPACEWAR_TRACE=<경로 접두사> 면 종료 시와 kill -USR2 때 Chrome trace 기록
+    trace_init_env("client");
+    trace_thread("main");
+    // SPACEWAR_LOG 가 없으면 표준 에러로 나가 게임 화면을 깨뜨리므로 오류만 남김
+    log_init_env("client");
+    log_thread("main");
+    if (getenv("SPACEWAR_LOG") == NULL) log_set_level(LOG_ERROR);
+    rollback_init(&rollback, -1);
+    input_init(&keys);
+    snapshot_init(&snapshots);
+    ring_init(&remote_inputs, sizeof(LockstepInput), REMOTE_INPUT_QUEUE);
     
     // 메인 게임 재시작 루프
     while (1) {
@@ -91,6 +437,8 @@ int main(int argc, char* argv[]) {
         //초기화
         memset(&game_state, 0, sizeof(GameState));
         id = -1;
+        playing = 0;
+        lockstep_started = 0;
         game_over = 0;
         winner = -1;
         game_running = 1;
@@ -98,14 +446,16 @@ int main(int argc, char* argv[]) {
         // 소켓 생성 및 연결
         server_sock = socket(AF_INET, SOCK_STREAM, 0);
         if (server_sock < 0) {
+            int err = errno;
             endwin();
-            perror("소켓 생성 실패");
+            log_error("소켓 생성 실패: %s", strerror(err));
             return 1;
         }
 
         // TCP_NODELAY 설정
         int flag = 1;
         setsockopt(server_sock, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof(int));
+        net_keepalive(server_sock, NET_IDLE_TIMEOUT_MS);  // 서버가 죽으면 수신 스레드가 몇 초 안에 깨어남
 
         struct sockaddr_in server_addr;
         memset(&server_addr, 0, sizeof(server_addr));
@@ -114,11 +464,17 @@ int main(int argc, char* argv[]) {
         server_addr.sin_port = htons(PORT);
 
         if (connect(server_sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            int err = errno;    // endwin 이 errno 를 덮어씀
             endwin();
-            perror("서버 연결 실패");
+            log_error("서버 연결 실패: %s: %s", argv[1], strerror(err));
             return 1;
         }
 
+        // 이전 판에서 남은 확정 상태와 상대 입력 버림
+        int stale;
+        snapshot_acquire(&snapshots, &stale);
+        ring_clear(&remote_inputs);
+
         // 수신 스레드 시작
         pthread_t recv_thread;
         pthread_create(&recv_thread, NULL, receive_thread, NULL);
@@ -131,7 +487,7 @@ int main(int argc, char* argv[]) {
         
         refresh();
 
-        pthread_mutex_lock(&state_mutex);
+        lock_state();
         while (id == -1 && game_running) {//플레이어가 할당 안되면
             pthread_cond_wait(&state_cond, &state_mutex);
         }
@@ -143,14 +499,19 @@ int main(int argc, char* argv[]) {
             break;
         }
 
+        // ID 를 받았으면 서버가 끊지 않도록 하트비트 시작
+        pthread_t hb_thread;
+        start_heartbeat(&hb_thread);
+
         // 내 연결 정보가 제대로 들어올 때까지 대기
-        pthread_mutex_lock(&state_mutex);
+        lock_state();
         while (!game_state.player[id].connected && game_running) {
             pthread_cond_wait(&state_cond, &state_mutex);
         }
         pthread_mutex_unlock(&state_mutex);
         
         if (!game_running) {
+            stop_heartbeat(hb_thread);
             close(server_sock);
             pthread_join(recv_thread, NULL);
             break;
@@ -166,7 +527,7 @@ int main(int argc, char* argv[]) {
         mvprintw(GAME_HEIGHT / 2 + 2, (GAME_WIDTH - strlen("Waiting for other player...")) / 2, "%s", "Waiting for other player...");
         refresh();
         
-        pthread_mutex_lock(&state_mutex);
+        lock_state();
         //상대방 연결 될때까지 대기
         while (!game_state.player[opponent_id].connected && game_running) {
             pthread_cond_wait(&state_cond, &state_mutex);
@@ -174,6 +535,7 @@ int main(int argc, char* argv[]) {
         pthread_mutex_unlock(&state_mutex);
         
         if (!game_running) {
+            stop_heartbeat(hb_thread);
             close(server_sock);
             pthread_join(recv_thread, NULL);
             break;
@@ -193,62 +555,145 @@ int main(int argc, char* argv[]) {
         mvprintw(GAME_HEIGHT / 2, (GAME_WIDTH - strlen("START!")) / 2, "%s", "START!");
         refresh();
         sleep(1);
+        view_invalidate(); // 게임 화면은 처음 한 번 전체를 그림
+
+        lock_state();
+        playing = 1;
+        int lockstep_mode = game_state.lockstep;
+        long long tick_ns = config_tick_ns(&game_state.config);  // 서버가 알려준 틱 속도
+        int view_frame = -1;    // 마지막으로 그린 프레임 (예측 포함, 입력에 실어 보내 서버 랙 보정 기준)
+        pthread_mutex_unlock(&state_mutex);
+        rollback_reset(&rollback, id);
+        input_clear(&keys);
+        int synced = 0; // 첫 확정 상태를 받기 전에는 예측하지 않음
+
+        if (lockstep_mode) {
+            lockstep_loop();
+        }
 
         // --- 메인 게임 루프 ---
-        while (game_running && !game_over) {
-            int ch;
-            int move_key = ERR;
-            int item_key = ERR;
-
-            while ((ch = getch()) != ERR) {
-                if (ch == 'q' || ch == 'Q') {
-                    game_running = 0;
-                    break;
-                }
-                if (ch == KEY_LEFT || ch == KEY_RIGHT || ch == KEY_UP || ch == KEY_DOWN) {
-                    move_key = ch;
-                } else if (ch >= '1' && ch <= '3') {
-                    item_key = ch;
-                }
+        // 키 입력, 시뮬레이션 틱, 화면 그리기를 각자 일정으로 스케줄링
+        // (키는 도착하는 즉시 읽고, 틱은 서버와 같은 주기, 그리기는 바뀐 게 있을 때 목표 주기 이하로)
+        long long now = now_ns();
+        long long next_tick = now, next_render = now;
+        int dirty = 1;
+        int changes = 0;                // 마지막 그리기 이후 상태가 바뀐 횟수
+
+        while (!lockstep_mode && game_running && !game_over) {
+            now = now_ns();
+
+            if (input_drain(&keys) > 0) {
+                dirty = 1;  // 이동은 틱 전에 미리 보여줌
             }
 
-            pthread_mutex_lock(&state_mutex);
+            // 서버 확정 상태가 오면 그 프레임으로 되감아 현재까지 재시뮬레이션
+            int fresh;
+            const GameState* confirmed = snapshot_acquire(&snapshots, &fresh);
+            if (fresh) {
+                long long t = trace_begin();
+                rollback_correct(&rollback, &game_state, confirmed);
+                trace_end("rollback_correct", t, confirmed->frame);
+                synced = 1;
+                dirty = 1;
+                changes++;
+            }
 
-            if (move_key != ERR) {
-                int dx = 0, dy = 0;
-                if (move_key == KEY_LEFT && game_state.player[id].x > 1) dx = -1;
-                else if (move_key == KEY_RIGHT && game_state.player[id].x < GAME_WIDTH - 2) dx = 1;
-                else if (move_key == KEY_UP && game_state.player[id].y > 1) dy = -1;
-                else if (move_key == KEY_DOWN && game_state.player[id].y < GAME_HEIGHT - 2) dy = 1;
-                
-                if (dx != 0 || dy != 0) {
-                    game_state.player[id].x += dx;
-                    game_state.player[id].y += dy;
+            if (now >= next_tick) {
+                long long tick = trace_begin();
+                FrameInput input;
+                memset(&input, 0, sizeof(input));
+
+                // 틱 사이에 들어온 이동을 모두 순서대로 적용 (서버에는 최종 위치만 보냄)
+                Player moved = game_state.player[id];
+                int moves = 0, items = 0, key;
+                while ((key = pop_tick_key(&moves, &items, INPUT_QUEUE)) != ERR) {
+                    if (is_item_key(key)) input.item = key - '0';
+                    else move_with_key(&moved, key);
+                }
+
+                if (moved.x != game_state.player[id].x || moved.y != game_state.player[id].y) {
+                    input.moved = 1;
+                    input.x = moved.x;
+                    input.y = moved.y;
                     
                     Packet packet;
+                    memset(&packet, 0, sizeof(packet));
                     packet.type = PLAYER_MOVE;
                     packet.id = id;
-                    packet.x = game_state.player[id].x;
-                    packet.y = game_state.player[id].y;
-                    send(server_sock, &packet, sizeof(Packet), 0);
+                    packet.x = input.x;
+                    packet.y = input.y;
+                    packet.frame = game_state.frame;
+                    packet.view_frame = view_frame;
+                    send_to_server(&packet);
+                }
+                
+                if (input.item) {
+                    Packet packet;
+                    memset(&packet, 0, sizeof(packet));
+                    packet.type = ITEM_USE;
+                    packet.id = id;
+                    packet.item_type = input.item;
+                    packet.frame = game_state.frame;
+                    packet.view_frame = view_frame;
+                    send_to_server(&packet);
+                }
+
+                // 입력은 바로 반영하고 서버와 같은 규칙으로 한 틱 예측
+                if (synced) {
+                    rollback_save(&rollback, &game_state, &input);
+                    rollback_apply_input(&game_state, id, &input);
+                    rollback_step(&game_state);
+                } else if (input.moved) {
+                    game_state.player[id].x = input.x;
+                    game_state.player[id].y = input.y;
+                }
+
+                trace_end("tick", tick, frame);
+                trace_poll();
+                frame++;
+                dirty = 1;
+                changes++;
+
+                // 고정 간격 유지, 한 틱 넘게 밀렸으면 몰아서 돌리지 않고 다시 맞춤
+                next_tick += tick_ns;
+                if (now - next_tick > tick_ns) {
+                    pacer.late_ticks++;
+                    next_tick = now + tick_ns;
                 }
-            }
-            
-            if (item_key != ERR) {
-                Packet packet;
-                packet.type = ITEM_USE;
-                packet.id = id;
-                packet.item_type = item_key - '0';
-                send(server_sock, &packet, sizeof(Packet), 0);
             }
 
-            draw_game(&game_state, id, frame);
+            if (dirty && now >= next_render) {
+                // 아직 틱에 반영되지 않은 이동은 내 위치만 미리 옮겨서 그림
+                const GameState* shown = &game_state;
+                if (keys.count > 0) {
+                    memcpy(&preview_state, &game_state, sizeof(GameState));
+                    for (int i = 0; i < keys.count; i++) {
+                        int key = input_peek(&keys, i)->key;
+                        if (is_move_key(key)) move_with_key(&preview_state.player[id], key);
+                    }
+                    shown = &preview_state;
+                }
 
-            pthread_mutex_unlock(&state_mutex);
+                long long cost = render(shown, frame);
+                long long done = now_ns();
+                if (synced) view_frame = shown->frame;  // 예측한 화살은 서버의 같은 프레임 화살과 같음
+                pacer_frame(&pacer, done, cost);
+                if (changes > 1) pacer.skipped += changes - 1;
+                changes = 0;
+                dirty = 0;
 
-            refresh();
-            frame++;
-            usleep(50000);
+                // 터미널이 못 따라오면 그리는 간격을 늘려 프레임을 건너뜀
+                // 터미널 출력 예산을 넘어 품질을 낮춘 경우에도 간격을 늘림
+                long long interval = view_frame_interval_us(RENDER_USEC, tick_ns) * 1000LL;
+                if (pacer.cost_avg_ns * 2 > interval) interval = pacer.cost_avg_ns * 2;
+                next_render = done + interval;
+            }
+
+            // 다음 할 일까지 대기 (키가 들어오면 바로 깸)
+            long long wake = next_tick;
+            if (dirty && next_render < wake) wake = next_render;
+            long long wait = wake - now_ns();
+            if (wait > 0) input_wait(wait / 1000);
         }
 
         // --- 게임 종료 화면 ---
@@ -270,6 +715,7 @@ int main(int argc, char* argv[]) {
             usleep(100000);
         }
 
+        stop_heartbeat(hb_thread);
         close(server_sock);
         pthread_join(recv_thread, NULL);
 
@@ -277,5 +723,26 @@ int main(int argc, char* argv[]) {
     }
 
     endwin();
+    trace_flush();
+
+    if (getenv("SPACEWAR_STATS")) {
+        rollback_report(&rollback, stderr);
+        fprintf(stderr, "[lockstep] frames=%lld stalls=%lld bytes_per_frame=%d\n",
+                lockstep.frames, lockstep.stalls, (int)sizeof(LockstepInput));
+        fprintf(stderr, "[snapshot] published=%lld acquired=%lld skipped=%lld\n",
+                snapshots.published, snapshots.acquired,
+                snapshots.published - snapshots.acquired);
+        fprintf(stderr, "[lock] state_mutex waits=%lld total=%lldus max=%lldus "
+                        "draw_unlocked=%lld avg=%lldus max=%lldus\n",
+                lock_waits, lock_wait_ns / 1000, lock_wait_max_ns / 1000,
+                draws, draws ? draw_ns / draws / 1000 : 0, draw_max_ns / 1000);
+        pacer_report(&pacer, stderr);
+        input_report(&keys, "input", stderr);
+        const ViewOutput* out = view_output();
+        fprintf(stderr, "[tty] bytes=%lld per_frame=%lld per_sec=%lld drain=%lldus "
+                        "budget=%lld quality=%d degrades=%lld\n",
+                out->total_bytes, out->frames ? out->total_bytes / out->frames : 0,
+                out->bytes_per_sec, out->drain_us, out->budget, out->quality, out->degrades);
+    }
     return 0;
 }
\ No newline at end of file
@@ -1,9 +1,15 @@
 #include "game_logic.h"
 #include "item.h"
+#include "profile.h"
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+// 게임별 난수 (스레드마다 독립된 게임을 돌릴 수 있도록 전역 rand() 대신 사용)
+static int game_rand(GameState* state) {
+    return rand_r(&state->seed);
+}
+
 static void create_arrow(Arrow* arrow, int start_x, int start_y, int target_x, int target_y, int special, int owner) {
     arrow->x = start_x;
     arrow->y = start_y;
@@ -47,10 +53,55 @@ static void create_arrow(Arrow* arrow, int start_x, int start_y, int target_x, i
     arrow->active = 1;
 }
 
+void default_config(GameConfig* config) {
+    config->tick_hz = TICK_HZ;
+    config->level_ms = 5000;
+    config->spawn_rate = 200;           // 초당 2발 (20 FPS 에서 틱당 10%)
+    config->spawn_rate_per_level = 40;
+    config->special_rate = 600;
+    config->special_rate_per_level = 80;
+    config->arrow_speed = 20;
+    config->damage_cooldown_ms = 2000;
+    config->redzone_lifetime_ms = 10000;
+    config->invincible_ms = 5000;
+    config->slow_ms = 10000;
+    config->wave_interval_ms = 10000;
+    config->wave_ms = 3000;
+    config->redzone_interval_ms = 20000;
+    config->attack_interval_ms = 5000;
+}
+
+int config_ticks(const GameConfig* config, int ms) {
+    int ticks = (int)(((long long)ms * config->tick_hz + 500) / 1000);
+    return ticks > 0 ? ticks : 1;
+}
+
+long long config_tick_ns(const GameConfig* config) {
+    return 1000000000LL / config->tick_hz;
+}
+
+long long game_elapsed_ms(const GameState* state) {
+    return (long long)state->frame * 1000 / state->config.tick_hz;
+}
+
+int game_level(const GameState* state) {
+    return (int)(game_elapsed_ms(state) / state->config.level_ms);
+}
+
+// 초당 rate/100 번 일어나는 사건을 한 틱에서 뽑기
+static int roll_rate(GameState* state, int rate) {
+    return game_rand(state) % (100 * state->config.tick_hz) < rate;
+}
+
+void seed_game(GameState* game_state, unsigned int seed) {
+    game_state->seed = seed;
+}
+
 void init_game(GameState* game_state, bool multiplay) {
     memset(game_state, 0, sizeof(GameState));
     game_state->multiplay = multiplay;
-    srand(time(NULL));
+    default_config(&game_state->config);
+    seed_game(game_state, (unsigned int)time(NULL));
 
     // Player 1
     game_state->player[0].x = multiplay ? 30 : GAME_WIDTH / 2;
@@ -75,7 +126,7 @@ void init_game(GameState* game_state, bool multiplay) {
 }
 
 
-void update_player(Player* player) {
+void update_player(Player* player, const GameConfig* config) {
     //무적상태이면
     if (player->invincible_frames > 0) {
         player->invincible_frames--; //무적 시간감소
@@ -92,7 +143,8 @@ void update_player(Player* player) {
     if (player-> damage_cooldown > 0) {//화살 충돌 후 무적 상태면
         player->damage_cooldown--;
     }
-    player->score++;
+    player->alive_ticks++;
+    player->score = (int)((long long)player->alive_ticks * SCORE_PER_SECOND / config->tick_hz);
 }
 
 void update_arrows(GameState* state, int width, int height) {
@@ -105,15 +157,18 @@ void update_arrows(GameState* state, int width, int height) {
         }
     }
 
+    // 초당 arrow_speed 칸 (슬로우 중에는 절반): 프레임까지 간 거리를 올림으로 세서
+    // 틱 속도와 관계없이 기본 틱 속도에서와 같은 시각 (20 FPS 의 짝수 프레임 등) 에 한 칸씩 이동
+    long long hz = state->config.tick_hz;
+    long long speed = is_any_slow ? state->config.arrow_speed / 2 : state->config.arrow_speed;
+    long long frame = state->frame;
+    int steps = (int)(((frame + 1) * speed + hz - 1) / hz - (frame * speed + hz - 1) / hz);
+
     for (int i = 0; i < MAX_ARROWS; i++) {
         if (!state->arrow[i].active) continue;
-        
-        //슬로우 상태면 짝수프레임 일때만 (화살 1/2로 생성)
-        //슬로우 상태아니면 정상 적으로 증가
-        if (!is_any_slow || state->frame % 2 == 0) {
-            state->arrow[i].x += state->arrow[i].dx;
-            state->arrow[i].y += state->arrow[i].dy;
-        }
+
+        state->arrow[i].x += state->arrow[i].dx * steps;
+        state->arrow[i].y += state->arrow[i].dy * steps;
 
         //화살이 벽만나면
         if (state->arrow[i].x <= 0 || state->arrow[i].x >= width - 1 ||
@@ -134,45 +189,87 @@ void update_redzones(GameState* state) {
     }
 }
 
-void damage(Player* player) {
+void move_player(Player* player, int dx, int dy) {
+    int x = player->x + dx;
+    int y = player->y + dy;
+
+    // 테두리 안쪽으로만 이동
+    if (x >= 1 && x <= GAME_WIDTH - 2) player->x = x;
+    if (y >= 1 && y <= GAME_HEIGHT - 2) player->y = y;
+}
+
+int damage(Player* player, const GameConfig* config) {
     if (player->invincible || player->damage_cooldown > 0) {
-        return;
+        return 0;
     }
     player->lives--;
-    player->damage_cooldown = 40;
+    player->damage_cooldown = config_ticks(config, config->damage_cooldown_ms);
+    return 1;
 }
 
-void check_collisions(GameState* state, int width, int height) {
-
-    (void)width; 
-    (void)height; 
+static DamageSource arrow_source(const Arrow* arrow) {
+    if (arrow->special == 2) return DAMAGE_ATTACK;
+    if (arrow->special == 1) return DAMAGE_SPECIAL;
+    return DAMAGE_ARROW;
+}
 
-    for (int idx = 0; idx < 2; idx++) {
-        Player* player = &state->player[idx];
-        if (!player->connected || player->lives <= 0) continue;
+void check_arrow_hits(GameState* state, int idx, Arrow* arrows) {
+    Player* player = &state->player[idx];
 
-        for (int i = 0; i < MAX_ARROWS; i++) {
-            if (state->arrow[i].active && state->arrow[i].x == player->x && state->arrow[i].y == player->y) {
-                if (state->arrow[i].owner != player->id) {
-                    damage(player);
+    for (int i = 0; i < MAX_ARROWS; i++) {
+        Arrow* arrow = &arrows[i];
+        if (arrow->active && arrow->x == player->x && arrow->y == player->y) {
+            if (arrow->owner != player->id) {
+                if (damage(player, &state->config)) {
+                    state->stats.damage[arrow_source(arrow)]++;
+                }
+                arrow->active = 0;
+                // 지난 틱의 화살로 판정했으면 지금 날아가고 있는 같은 화살도 제거
+                if (state->arrow[i].born == arrow->born) {
                     state->arrow[i].active = 0;
                 }
             }
         }
+    }
+}
+
+void check_redzone_hits(GameState* state, int idx) {
+    Player* player = &state->player[idx];
 
-        for (int i = 0; i < MAX_REDZONES; i++) {
-            if (state->redzone[i].active) {
-                if (player->x >= state->redzone[i].x &&
-                    player->x < state->redzone[i].x + state->redzone[i].width &&
-                    player->y >= state->redzone[i].y &&
-                    player->y < state->redzone[i].y + state->redzone[i].height) {
-                    damage(player);
+    for (int i = 0; i < MAX_REDZONES; i++) {
+        if (state->redzone[i].active) {
+            if (player->x >= state->redzone[i].x &&
+                player->x < state->redzone[i].x + state->redzone[i].width &&
+                player->y >= state->redzone[i].y &&
+                player->y < state->redzone[i].y + state->redzone[i].height) {
+                if (damage(player, &state->config)) {
+                    state->stats.damage[DAMAGE_REDZONE]++;
                 }
             }
         }
     }
 }
 
+void check_collisions(GameState* state, int width, int height) {
+
+    (void)width; 
+    (void)height; 
+
+    for (int idx = 0; idx < 2; idx++) {
+        Player* player = &state->player[idx];
+        if (!player->connected || player->lives <= 0) continue;
+
+        check_arrow_hits(state, idx, state->arrow);
+        check_redzone_hits(state, idx);
+    }
+}
+
+static void (*collision_handler)(GameState* state, int width, int height) = NULL;
+
+void set_collision_handler(void (*handler)(GameState* state, int width, int height)) {
+    collision_handler = handler;
+}
+
 //화살 발사 함수
 void spawn_arrow(GameState* state, int width, int height, bool is_special, int id) {
 
@@ -180,25 +277,25 @@ void spawn_arrow(GameState* state, int width, int height, bool is_special, int i
 
         if (!state->arrow[i].active) {
             //발사할 가장자리 랜덤 
-            int edge = rand() % 4;
+            int edge = game_rand(state) % 4;
 
             int start_x, start_y;
             
             switch (edge) {
                 case 0: // 왼쪽 가장자리
                     start_x = 1;
-                    start_y = rand() % (height - 2) + 1;
+                    start_y = game_rand(state) % (height - 2) + 1;
                     break;
                 case 1: // 오른쪽 가장자리
                     start_x = width - 2;
-                    start_y = rand() % (height - 2) + 1;
+                    start_y = game_rand(state) % (height - 2) + 1;
                     break;
                 case 2: // 위쪽 가장자리
-                    start_x = rand() % (width - 2) + 1;
+                    start_x = game_rand(state) % (width - 2) + 1;
                     start_y = 1;
                     break;
-                case 3: // 아래쪽 가장자리
-                    start_x = rand() % (width - 2) + 1;
+                default: // 아래쪽 가장자리
+                    start_x = game_rand(state) % (width - 2) + 1;
                     start_y = height - 2;
                     break;
             }
@@ -206,23 +303,28 @@ void spawn_arrow(GameState* state, int width, int height, bool is_special, int i
             if (state->player[id].connected && state->player[id].lives > 0) {
                 create_arrow(&state->arrow[i], start_x, start_y,
                                state->player[id].x, state->player[id].y, is_special, -1);
+                state->arrow[i].born = state->frame;
+                state->stats.arrows_spawned++;
             }
     
             //화살 생성했으면 종료
-            break;
+            return;
         }
     }
+
+    // 빈 슬롯이 없어 생성 실패
+    state->stats.spawn_drops++;
 }
 
 
 void redZone(GameState* state, int width, int height) {
     for (int i = 0; i < MAX_REDZONES; i++) {
         if (!state->redzone[i].active) {
-            state->redzone[i].width = 5 + rand() % 8;
-            state->redzone[i].height = 3 + rand() % 5;
-            state->redzone[i].x = 2 + rand() % (width - state->redzone[i].width - 3);
-            state->redzone[i].y = 2 + rand() % (height - state->redzone[i].height - 3);
-            state->redzone[i].lifetime = 200;
+            state->redzone[i].width = 5 + game_rand(state) % 8;
+            state->redzone[i].height = 3 + game_rand(state) % 5;
+            state->redzone[i].x = 2 + game_rand(state) % (width - state->redzone[i].width - 3);
+            state->redzone[i].y = 2 + game_rand(state) % (height - state->redzone[i].height - 3);
+            state->redzone[i].lifetime = config_ticks(&state->config, state->config.redzone_lifetime_ms);
             state->redzone[i].active = 1;
             break;
         }
@@ -248,6 +350,7 @@ void create_player_attack(GameState* state, int id) {
                 if (!state->arrow[i].active) {
                     
                     create_arrow(&state->arrow[i], x, y, x + directions[d][0], y + directions[d][1], 2, id);
+                    state->arrow[i].born = state->frame;
                     break;
                 }
             }
@@ -260,6 +363,7 @@ void create_player_attack(GameState* state, int id) {
             if (!state->arrow[i].active) {
 
                 create_arrow(&state->arrow[i], x, y, x, y - 1, 2, id);
+                state->arrow[i].born = state->frame;
                 break;
             }
         }
@@ -269,17 +373,30 @@ void create_player_attack(GameState* state, int id) {
 
 
 void update_game(GameState* state, int width, int height) {
+    long long t = prof_begin();
     for (int i = 0; i < 2; i++) {
         if (state->player[i].connected && state->player[i].lives > 0) {
-            update_player(&state->player[i]);
+            update_player(&state->player[i], &state->config);
         }
     }
+    prof_end(PROF_PLAYERS, t);
 
+    t = prof_begin();
     update_arrows(state, width, height);
+    prof_end(PROF_ARROWS, t);
+
+    t = prof_begin();
     update_redzones(state);
-    check_collisions(state, width, height);
+    prof_end(PROF_REDZONES, t);
+
+    t = prof_begin();
+    if (collision_handler != NULL) collision_handler(state, width, height);
+    else check_collisions(state, width, height);
+    prof_end(PROF_COLLISIONS, t);
 
-    int level = state->frame / 100;
+    t = prof_begin();
+    const GameConfig* cfg = &state->config;
+    int level = game_level(state);
     int connected_players = 0;
 
     if(state->multiplay)connected_players=2;
@@ -287,20 +404,46 @@ void update_game(GameState* state, int width, int height) {
     //화살 증가 중이면 증가 생성
     if (state->special_wave > 0) {
         state->special_wave--;
-        if (rand() % 100 < 30 + level * 4) {
+        if (roll_rate(state, cfg->special_rate + level * cfg->special_rate_per_level)) {
             
             //싱글이면 표적은 player 0아니면 랜덤
-            int target_id = (connected_players > 1) ? (rand() % 2) : 0;
+            int target_id = (connected_players > 1) ? (game_rand(state) % 2) : 0;
             spawn_arrow(state, width, height, true, target_id);
         }
     }
 
     //레벨에 맞는 화살생성
-    if (rand() % 100 < 10 + level * 2) {
+    if (roll_rate(state, cfg->spawn_rate + level * cfg->spawn_rate_per_level)) {
     
-        int target_id = (connected_players > 1) ? (rand() % 2) : 0;
+        int target_id = (connected_players > 1) ? (game_rand(state) % 2) : 0;
         spawn_arrow(state, width, height, false, target_id);
     }
+    prof_end(PROF_SPAWN, t);
 
     state->frame++;
 }
+
+// 주기 이벤트 (특수 웨이브, 레드존, 플레이어 공격)
+// 예전에는 SIGALRM 으로 처리했지만 프레임 기준으로 돌려야 시뮬레이션/재현이 가능함
+void update_events(GameState* state, int width, int height) {
+    const GameConfig* cfg = &state->config;
+    if (state->frame <= 0) return;
+    long long t = prof_begin();
+
+    if (state->frame % config_ticks(cfg, cfg->wave_interval_ms) == 0) {
+        state->special_wave = config_ticks(cfg, cfg->wave_ms);
+    }
+
+    if (state->frame % config_ticks(cfg, cfg->redzone_interval_ms) == 0) {
+        redZone(state, width, height);
+    }
+
+    if (state->multiplay && state->frame % config_ticks(cfg, cfg->attack_interval_ms) == 0) {
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            if (state->player[i].connected && state->player[i].lives > 0) {
+                create_player_attack(state, i);
+            }
+        }
+    }
+    prof_end(PROF_EVENTS, t);
+}
@@ -0,0 +1,77 @@
+#include "input.h"
+#include <curses.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include "timeutil.h"
+
+void input_init(InputQueue* q) {
+    memset(q, 0, sizeof(InputQueue));
+}
+
+void input_clear(InputQueue* q) {
+    q->head = 0;
+    q->count = 0;
+    q->unshown_ns = 0;
+}
+
+int input_wait(long long timeout_us) {
+    struct pollfd pfd;
+    pfd.fd = STDIN_FILENO;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int timeout_ms = timeout_us > 0 ? (int)((timeout_us + 999) / 1000) : 0;
+    return poll(&pfd, 1, timeout_ms) > 0;
+}
+
+int input_drain(InputQueue* q) {
+    int added = 0;
+
+    // 큐가 가득 차면 나머지는 tty 에 남겨 두고 다음 호출에서 읽음 (버리지 않음)
+    while (q->count < INPUT_QUEUE) {
+        int ch = getch();
+        if (ch == ERR) break;
+
+        KeyEvent* ev = &q->events[(q->head + q->count) % INPUT_QUEUE];
+        ev->key = ch;
+        ev->ts_ns = now_ns();
+        if (q->unshown_ns == 0) q->unshown_ns = ev->ts_ns;
+
+        q->count++;
+        q->keys++;
+        added++;
+    }
+    return added;
+}
+
+int input_pop(InputQueue* q, KeyEvent* ev) {
+    if (q->count == 0) return -1;
+
+    *ev = q->events[q->head];
+    q->head = (q->head + 1) % INPUT_QUEUE;
+    q->count--;
+    return 0;
+}
+
+const KeyEvent* input_peek(const InputQueue* q, int index) {
+    if (index < 0 || index >= q->count) return NULL;
+    return &q->events[(q->head + index) % INPUT_QUEUE];
+}
+
+void input_shown(InputQueue* q, long long shown_ns) {
+    if (q->unshown_ns == 0) return;
+
+    long long latency = shown_ns - q->unshown_ns;
+    q->latency_sum_ns += latency;
+    q->latency_count++;
+    if (latency > q->latency_max_ns) q->latency_max_ns = latency;
+    q->unshown_ns = 0;
+}
+
+void input_report(const InputQueue* q, const char* tag, FILE* out) {
+    fprintf(out, "[%s] keys=%lld shown=%lld latency_avg=%lldus max=%lldus\n",
+            tag, q->keys, q->latency_count,
+            q->latency_count ? q->latency_sum_ns / q->latency_count / 1000 : 0,
+            q->latency_max_ns / 1000);
+}
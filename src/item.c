@@ -1,10 +1,11 @@
 #include "item.h"
+#include "game_logic.h"
 
-void invincible_item(Player* player) {
+void invincible_item(Player* player, const GameConfig* config) {
     if (player->invincible_item > 0) {
         player->invincible_item--;
         player->invincible = 1;
-        player->invincible_frames = 100;
+        player->invincible_frames = config_ticks(config, config->invincible_ms);
     }
 }
 
@@ -15,11 +16,11 @@ void heal_item(Player* player) {
     }
 }
 
-void slow_item(Player* player) {
+void slow_item(Player* player, const GameConfig* config) {
     if (player->slow_item > 0) {
         player->slow_item--;
         player->slow = 1;
-        player->slow_frames = 200;
+        player->slow_frames = config_ticks(config, config->slow_ms);
     }
 }
 
@@ -0,0 +1,107 @@
+#include "lagcomp.h"
+#include "game_logic.h"
+#include "timeutil.h"
+#include <string.h>
+
+void lagcomp_init(LagComp* lc, int max_ms, int tick_hz) {
+    memset(lc, 0, sizeof(LagComp));
+    lc->max_ticks = (int)((long long)max_ms * tick_hz / 1000);
+    if (lc->max_ticks > LAGCOMP_HISTORY - 1) lc->max_ticks = LAGCOMP_HISTORY - 1;
+    lagcomp_reset(lc);
+}
+
+void lagcomp_reset(LagComp* lc) {
+    for (int i = 0; i < LAGCOMP_HISTORY; i++) {
+        lc->frame[i] = -1;
+    }
+    memset(lc->lag_x16, 0, sizeof(lc->lag_x16));
+}
+
+void lagcomp_input(LagComp* lc, int id, int view_frame, int server_frame) {
+    if (view_frame < 0) return;         // 아직 화면에 판을 그리지 않은 클라이언트
+    int late = server_frame - view_frame;
+    if (late < 0) late = 0;             // 서버보다 앞서 예측해 그리는 클라이언트는 제때 도착
+    if (late >= LAGCOMP_HISTORY) return; // 기록 밖은 무시
+    lc->lag_x16[id] = (lc->lag_x16[id] * 3 + late * 16) / 4;
+}
+
+int lagcomp_rewind(const LagComp* lc, int id) {
+    int rewind = (lc->lag_x16[id] + 8) / 16;
+    return rewind < lc->max_ticks ? rewind : lc->max_ticks;
+}
+
+// 이 위치에 있는 남의 화살이 하나라도 있는지 (판정 결과 비교용, 상태는 바꾸지 않음)
+static int hit_by(const Arrow* arrows, const Player* player) {
+    for (int i = 0; i < MAX_ARROWS; i++) {
+        if (arrows[i].active && arrows[i].x == player->x && arrows[i].y == player->y &&
+            arrows[i].owner != player->id) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 맞아서 사라진 화살은 다른 틱 기록에서도 지움 (되감는 폭이 바뀌어도 두 번 맞지 않도록)
+static void consume(LagComp* lc, int slot, int born) {
+    for (int h = 0; h < LAGCOMP_HISTORY; h++) {
+        if (lc->frame[h] >= 0 && lc->arrow[h][slot].born == born) {
+            lc->arrow[h][slot].active = 0;
+        }
+    }
+}
+
+void lagcomp_collisions(LagComp* lc, GameState* state) {
+    long long start = now_ns();
+
+    int now = state->frame % LAGCOMP_HISTORY;
+    lc->frame[now] = state->frame;
+    memcpy(lc->arrow[now], state->arrow, sizeof(state->arrow));
+
+    for (int idx = 0; idx < MAX_PLAYERS; idx++) {
+        Player* player = &state->player[idx];
+        if (!player->connected || player->lives <= 0) continue;
+
+        // 기록이 없으면 (판 시작 직후) 있는 만큼만 되감음
+        int rewind = lagcomp_rewind(lc, idx);
+        while (rewind > 0 && (state->frame - rewind < 0 ||
+               lc->frame[(state->frame - rewind) % LAGCOMP_HISTORY] != state->frame - rewind)) {
+            rewind--;
+        }
+        Arrow* view = lc->arrow[(state->frame - rewind) % LAGCOMP_HISTORY];
+
+        lc->checks++;
+        if (rewind > 0) {
+            lc->rewinds++;
+            lc->rewind_ticks += rewind;
+            if (!player->invincible && player->damage_cooldown == 0) {
+                int now_hit = hit_by(state->arrow, player);
+                int view_hit = hit_by(view, player);
+                if (now_hit && !view_hit) lc->forgiven++;
+                if (!now_hit && view_hit) lc->late_hits++;
+            }
+        }
+
+        int active[MAX_ARROWS];
+        for (int i = 0; i < MAX_ARROWS; i++) active[i] = view[i].active;
+        check_arrow_hits(state, idx, view);
+        for (int i = 0; i < MAX_ARROWS; i++) {
+            if (active[i] && !view[i].active) consume(lc, i, view[i].born);
+        }
+
+        check_redzone_hits(state, idx);
+    }
+
+    long long elapsed = now_ns() - start;
+    lc->ticks++;
+    lc->check_ns += elapsed;
+    if (elapsed > lc->check_max_ns) lc->check_max_ns = elapsed;
+}
+
+void lagcomp_report(const LagComp* lc, char* buf, size_t size) {
+    snprintf(buf, size, "[lagcomp] max=%dticks checks=%lld rewinds=%lld avg_rewind=%.1fticks "
+                 "forgiven=%lld late_hits=%lld avg_check=%lldns max=%lldns",
+            lc->max_ticks, lc->checks, lc->rewinds,
+            lc->rewinds ? (double)lc->rewind_ticks / lc->rewinds : 0.0,
+            lc->forgiven, lc->late_hits,
+            lc->ticks ? lc->check_ns / lc->ticks : 0, lc->check_max_ns);
+}
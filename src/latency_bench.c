@@ -0,0 +1,571 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include "common.h"
+#include "game_logic.h"
+#include "view.h"
+#include "net.h"
+#include "timeutil.h"
+#include "rollback.h"
+
+// 입력 -> 화면 지연 벤치마크
+// 로컬 서버 (--tick-hz) 를 띄우고 화면 없는 클라이언트를 붙여, 번호를 붙인 이동 입력이
+// 서버 STATE_UPDATE 의 ack_trace 로 돌아와 화면에 그려질 때까지 단계별 지연을 잰다.
+// 모든 시각은 CLOCK_MONOTONIC 이라 서버와 클라이언트가 같은 호스트에 있어야 한다.
+// 화면은 /dev/null 을 터미널로 삼아 실제 그리기 코드 (draw_game + view_present) 를 그대로 돌린다.
+// -l 을 주면 클라이언트가 입력을 그만큼 늦게 보내고 (느린 상향 링크), 서버 메트릭에서 랙 보정이
+// 실제로 되감아 판정했는지 확인한다. -P 면 클라이언트가 실제 클라이언트처럼 롤백으로 앞서 예측해
+// 그린 프레임을 보내며, 이때는 입력이 늦어도 거의 되감지 않아야 한다.
+
+#define DEFAULT_TICK_HZ  (1000000 / TICK_USEC)
+#define DEFAULT_SEND_HZ  (1000000 / TICK_USEC)
+#define DEFAULT_KEY_HZ   10
+#define DEFAULT_SECONDS  10
+#define DEFAULT_CLIENTS  MAX_PLAYERS
+#define MAX_SAMPLES      65536      // 단계별 보관 샘플 수 (넘으면 앞부분만)
+#define PENDING          1024       // 응답을 기다리는 입력 (번호 % PENDING)
+#define START_TIMEOUT_NS (15 * 1000000000LL)    // 서버 카운트다운 (5초) + 여유
+#define HIST_BUCKETS     14         // 전체 지연 히스토그램: 0.25ms 부터 2 배씩
+#define METRICS_PORT     9479       // -l, -P 일 때 서버 메트릭 포트 (랙 보정 확인)
+#define PREDICT_REWIND_MAX 1        // -P: 판정당 평균 되감은 틱이 이를 넘으면 실패 (타임라인이 리드보다 조금 처지는 것만 허용)
+
+typedef enum {
+    STAGE_SAMPLE,       // 키 입력 -> 전송 (입력 주기만큼 모아서 보냄)
+    STAGE_SEND,         // 전송 -> 서버 수신
+    STAGE_QUEUE,        // 서버 수신 -> 틱에서 적용 (다음 틱까지 입력 큐에서 대기)
+    STAGE_SIMULATE,     // 적용 -> STATE_UPDATE 전송 (update_game + 직렬화)
+    STAGE_BROADCAST,    // 서버 전송 -> 클라이언트 수신
+    STAGE_RENDER,       // 클라이언트 수신 -> 화면 출력 완료
+    STAGE_TOTAL,        // 키 입력 -> 화면 출력 완료
+    STAGES
+} Stage;
+
+static const char* stage_names[STAGES] = {
+    "sample", "send", "queue", "simulate", "broadcast", "render", "total"
+};
+
+// 클라이언트 프로세스가 채우는 결과 (부모와 공유 메모리)
+typedef struct {
+    long long count[STAGES];
+    long long samples[STAGES][MAX_SAMPLES];
+    long long keys;             // 만든 키 입력 수
+    long long inputs;           // 보낸 입력 패킷 수
+    long long echoed;           // 번호 그대로 돌아온 입력
+    long long merged;           // 같은 틱에 뒤 입력과 합쳐져 돌아온 입력 (total 만 기록)
+    long long snapshots;
+    long long measured_ns;      // 실제 측정 시간
+    int game_over;              // 측정 중 게임이 끝남
+    int failed;
+} ClientStats;
+
+typedef struct {
+    int tick_hz;
+    int send_hz;
+    int key_hz;
+    int seconds;
+    int clients;
+    int render;
+    int lag_ms;                 // 입력을 보내기 전에 붙잡아 두는 시간 (0: 바로 보냄)
+    int predict;                // 롤백 예측 (입력은 틱마다, 그리는 것은 예측한 상태)
+} BenchOptions;
+
+// 보냈지만 아직 돌아오지 않은 입력
+typedef struct {
+    int input_id;
+    long long key_ns;           // 이 입력에 담긴 가장 오래된 키
+    long long sent_ns;
+} PendingInput;
+
+// lag_ms 동안 붙잡아 둔 입력 (보낼 시각 순)
+typedef struct {
+    int input_id;
+    int x, y;
+    int frame;                  // 입력을 적용한 예측 프레임 (예측하지 않으면 0)
+    int view_frame;
+    long long sent_ns;
+    long long due_ns;
+} DelayedInput;
+
+static void record(ClientStats* stats, Stage stage, long long ns) {
+    if (stats->count[stage] < MAX_SAMPLES) stats->samples[stage][stats->count[stage]] = ns;
+    stats->count[stage]++;
+}
+
+static int connect_server(void) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == -1) return -1;
+    int flag = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(PORT);
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// /dev/null 을 터미널로 쓰는 화면 (출력 비용은 실제 터미널보다 작게 나옴)
+static int open_null_screen(void) {
+    FILE* out = fopen("/dev/null", "w");
+    FILE* in = fopen("/dev/null", "r");
+    if (out == NULL || in == NULL || newterm("xterm", out, in) == NULL) return -1;
+    view_setup();
+    return 0;
+}
+
+// 키 입력 간격 (평균 1/key_hz 초의 지수 분포)
+static long long next_key_gap(unsigned int* seed, int key_hz) {
+    double u = (rand_r(seed) + 1.0) / ((double)RAND_MAX + 2.0);
+    return (long long)(-log(u) * 1e9 / key_hz);
+}
+
+// 돌아온 입력의 단계별 지연 기록 (rendered: 화면 출력 완료 시각)
+static void complete_inputs(ClientStats* stats, PendingInput* pending, int* oldest, int acked,
+                            const InputTrace* trace, long long sent_ns, long long recv_ns,
+                            long long rendered) {
+    for (; *oldest <= acked; (*oldest)++) {
+        PendingInput* p = &pending[*oldest % PENDING];
+        if (p->input_id != *oldest) continue;
+        p->input_id = 0;
+        record(stats, STAGE_TOTAL, rendered - p->key_ns);
+        if (*oldest != acked) {
+            stats->merged++;
+            continue;
+        }
+
+        stats->echoed++;
+        record(stats, STAGE_SAMPLE, p->sent_ns - p->key_ns);
+        record(stats, STAGE_SEND, trace->recv_ns - p->sent_ns);
+        record(stats, STAGE_QUEUE, trace->apply_ns - trace->recv_ns);
+        record(stats, STAGE_SIMULATE, sent_ns - trace->apply_ns);
+        record(stats, STAGE_BROADCAST, recv_ns - sent_ns);
+        record(stats, STAGE_RENDER, rendered - recv_ns);
+    }
+}
+
+// 화면 없는 클라이언트 한 판: 첫 STATE_UPDATE 부터 seconds 동안 입력을 보내고 돌아오는 지연을 잼
+static void run_client(const BenchOptions* opt, int index, ClientStats* stats) {
+    static Packet packet;
+    static PendingInput pending[PENDING];
+    static DelayedInput outbox[PENDING];
+    static Rollback rollback;
+    static GameState live;          // 예측 중인 상태 (-P)
+    int out_head = 0, out_tail = 0;
+    int view_frame = -1;            // 마지막으로 그린 프레임 (-P 면 예측한 프레임)
+    long long lag_ns = opt->lag_ms * 1000000LL;
+    unsigned int seed = (unsigned int)(now_ns() ^ index);
+
+    int sock = connect_server();
+    if (sock == -1 || (opt->render && open_null_screen() == -1)) {
+        stats->failed = 1;
+        return;
+    }
+
+    int id = -1;
+    int next_id = 1, oldest = 1;
+    int dir = 1;
+    // 예측하면 실제 클라이언트처럼 틱마다 입력을 모아 보냄
+    long long send_interval = 1000000000LL / (opt->predict ? opt->tick_hz : opt->send_hz);
+    long long begin = now_ns(), started = 0, end = 0;
+    long long next_send = 0, next_key = 0;
+    long long key_ns = 0;           // 아직 보내지 않은 가장 오래된 키 (0: 없음)
+    long long last_write = begin;   // 보낼 입력이 없는 동안에는 하트비트 (서버 유휴 제한)
+    int x = 0, y = 0;
+
+    while (1) {
+        long long now = now_ns();
+        if (started == 0 && now - begin > START_TIMEOUT_NS) {
+            stats->failed = 1;
+            break;
+        }
+        if (started != 0 && now >= end) break;
+
+        // 키는 틱과 무관하게 들어오고, 입력 주기마다 그동안의 이동을 패킷 하나로 보냄
+        if (started != 0 && now >= next_key) {
+            if (key_ns == 0) key_ns = now;
+            stats->keys++;
+            next_key = now + next_key_gap(&seed, opt->key_hz);
+        }
+        if (started != 0 && now >= next_send) {
+            FrameInput input;
+            memset(&input, 0, sizeof(input));
+            if (key_ns != 0 && id >= 0) {
+                if (x + dir < 1 || x + dir >= GAME_WIDTH - 1) dir = -dir;
+                x += dir;
+                input.moved = 1;
+                input.x = x;
+                input.y = y;
+
+                // 보낸 시각은 붙잡기 전이라 send 단계에 lag_ms 가 들어감
+                DelayedInput* d = &outbox[out_tail++ % PENDING];
+                d->input_id = next_id;
+                d->x = x;
+                d->y = y;
+                d->frame = opt->predict ? live.frame : 0;
+                d->view_frame = view_frame;
+                d->sent_ns = now_ns();
+                d->due_ns = d->sent_ns + lag_ns;
+                PendingInput* p = &pending[next_id % PENDING];
+                p->input_id = next_id;
+                p->key_ns = key_ns;
+                p->sent_ns = d->sent_ns;
+                stats->inputs++;
+                next_id++;
+                key_ns = 0;
+            }
+            // 클라이언트와 같이 입력을 바로 반영하고 한 틱 예측
+            if (opt->predict) {
+                rollback_save(&rollback, &live, &input);
+                rollback_apply_input(&live, id, &input);
+                rollback_step(&live);
+                view_frame = live.frame;
+            }
+            next_send += send_interval;
+            if (next_send < now) next_send = now + send_interval;
+        }
+
+        int write_failed = 0;
+        while (out_head < out_tail && outbox[out_head % PENDING].due_ns <= now_ns()) {
+            const DelayedInput* d = &outbox[out_head++ % PENDING];
+            memset(&packet, 0, sizeof(packet));
+            packet.type = PLAYER_MOVE;
+            packet.id = id;
+            packet.x = d->x;
+            packet.y = d->y;
+            packet.input_id = d->input_id;
+            packet.frame = d->frame;
+            packet.sent_ns = d->sent_ns;
+            packet.view_frame = d->view_frame;
+            if (net_write_full(sock, &packet, sizeof(packet)) != 0) {
+                write_failed = 1;
+                break;
+            }
+            last_write = now;
+        }
+        if (write_failed) break;
+
+        if (id >= 0 && now - last_write >= NET_HEARTBEAT_MS * 1000000LL) {
+            memset(&packet, 0, sizeof(packet));
+            packet.type = HEARTBEAT;
+            packet.id = id;
+            if (net_write_full(sock, &packet, sizeof(packet)) != 0) break;
+            last_write = now;
+        }
+
+        long long wake = started != 0 ? end : begin + START_TIMEOUT_NS;
+        if (id >= 0 && last_write + NET_HEARTBEAT_MS * 1000000LL < wake) wake = last_write + NET_HEARTBEAT_MS * 1000000LL;
+        if (started != 0 && next_send < wake) wake = next_send;
+        if (started != 0 && next_key < wake) wake = next_key;
+        if (out_head < out_tail && outbox[out_head % PENDING].due_ns < wake) wake = outbox[out_head % PENDING].due_ns;
+        long long wait_ms = (wake - now_ns() + 999999) / 1000000;
+        struct pollfd pfd = { sock, POLLIN, 0 };
+        if (poll(&pfd, 1, wait_ms > 0 ? (int)wait_ms : 0) <= 0) continue;
+
+        if (net_read_full(sock, &packet, sizeof(packet)) != 0) break;
+        long long recv_ns = now_ns();
+
+        if (packet.type == INITIAL_STATE) {
+            id = packet.id;
+            rollback_init(&rollback, id);
+            memset(&live, 0, sizeof(live));
+        } else if (packet.type == GAME_OVER && started != 0) {
+            stats->game_over = 1;
+            break;
+        } else if (packet.type == STATE_UPDATE && id >= 0) {
+            const Player* me = &packet.game_state.player[id];
+            if (started == 0) {
+                started = recv_ns;
+                end = started + opt->seconds * 1000000000LL;
+                next_send = next_key = started;
+                x = me->x;
+                y = me->y;
+            }
+            stats->snapshots++;
+
+            // 예측하면 확정 상태로 되감아 재시뮬레이션한 상태를 그림
+            const GameState* shown = &packet.game_state;
+            if (opt->predict) {
+                rollback_correct(&rollback, &live, &packet.game_state);
+                shown = &live;
+            }
+            view_frame = shown->frame;
+
+            long long rendered = recv_ns;
+            if (opt->render) {
+                draw_game(shown, id, shown->frame);
+                view_present();
+                rendered = now_ns();
+            }
+
+            int acked = me->ack_trace.input_id;
+            if (acked >= oldest && acked < next_id) {
+                complete_inputs(stats, pending, &oldest, acked, &me->ack_trace,
+                                packet.sent_ns, recv_ns, rendered);
+            }
+        }
+    }
+
+    if (started != 0) stats->measured_ns = now_ns() - started;
+    if (opt->render) endwin();
+    close(sock);
+}
+
+// 서버 실행 후 준비 알림 대기 (실패 시 -1), metrics_port 가 0 이 아니면 메트릭도 켬
+static pid_t start_server(const char* path, int tick_hz, int metrics_port) {
+    int ready[2];
+    if (pipe(ready) == -1) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        char hz[16], fd[16], port[16];
+        snprintf(hz, sizeof(hz), "%d", tick_hz);
+        snprintf(port, sizeof(port), "%d", metrics_port);
+        snprintf(fd, sizeof(fd), "%d", ready[1]);
+        close(ready[0]);
+        setenv(NET_READY_ENV, fd, 1);
+        freopen("/dev/null", "w", stdout);
+        if (metrics_port > 0) execl(path, "server", "--tick-hz", hz, "--metrics-port", port, NULL);
+        else execl(path, "server", "--tick-hz", hz, NULL);
+        perror(path);
+        _exit(1);
+    }
+    close(ready[1]);
+
+    char reason[256];
+    int started = pid > 0 ? net_wait_ready(ready[0], NET_READY_TIMEOUT_MS, reason, sizeof(reason)) : -1;
+    close(ready[0]);
+    if (started != 0) {
+        if (pid > 0) {
+            fprintf(stderr, "서버 시작 실패: %s\n", reason);
+            kill(pid, SIGTERM);
+            waitpid(pid, NULL, 0);
+        }
+        return -1;
+    }
+    return pid;
+}
+
+// 서버 메트릭에서 name 지표 값의 합 (레이블이 다른 줄도 더함, 실패 시 -1)
+static long long scrape_metric(int port, const char* name) {
+    static char buf[65536];
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == -1) return -1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    const char* request = "GET /metrics HTTP/1.0\r\n\r\n";
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == -1 ||
+        net_write_full(sock, request, strlen(request)) != 0) {
+        close(sock);
+        return -1;
+    }
+
+    size_t len = 0;
+    ssize_t n;
+    while (len < sizeof(buf) - 1 && (n = read(sock, buf + len, sizeof(buf) - 1 - len)) > 0) len += (size_t)n;
+    buf[len] = '\0';
+    close(sock);
+
+    long long sum = -1;
+    size_t name_len = strlen(name);
+    for (char* line = buf; line != NULL && *line != '\0'; ) {
+        char* next = strchr(line, '\n');
+        if (strncmp(line, name, name_len) == 0 && (line[name_len] == ' ' || line[name_len] == '{')) {
+            const char* value = strchr(line + name_len, ' ');
+            if (value != NULL) sum = (sum < 0 ? 0 : sum) + atoll(value + 1);
+        }
+        line = next != NULL ? next + 1 : NULL;
+    }
+    return sum;
+}
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static double ms(long long ns) {
+    return ns / 1e6;
+}
+
+// 모든 클라이언트의 샘플을 합쳐 단계별 분위수와 전체 지연 히스토그램 출력
+static void report(const BenchOptions* opt, ClientStats* clients) {
+    long long keys = 0, inputs = 0, echoed = 0, merged = 0, snapshots = 0, measured = 0;
+    for (int c = 0; c < opt->clients; c++) {
+        keys += clients[c].keys;
+        inputs += clients[c].inputs;
+        echoed += clients[c].echoed;
+        merged += clients[c].merged;
+        snapshots += clients[c].snapshots;
+        if (clients[c].measured_ns > measured) measured = clients[c].measured_ns;
+    }
+    printf("tick %d Hz, send %d Hz, keys %d/s, %d clients, %.1f s%s\n",
+           opt->tick_hz, opt->send_hz, opt->key_hz, opt->clients, measured / 1e9,
+           opt->render ? "" : " (render off)");
+    printf("keys %lld, inputs %lld (echoed %lld, merged %lld), snapshots %lld\n\n",
+           keys, inputs, echoed, merged, snapshots);
+
+    printf("  %-10s %8s %9s %9s %9s %9s %9s\n", "stage", "count", "mean", "p50", "p90", "p99", "max");
+    long long* sorted = malloc(sizeof(long long) * MAX_SAMPLES * opt->clients);
+    long long total_n = 0;
+    for (int s = 0; s < STAGES && sorted != NULL; s++) {
+        long long n = 0;
+        for (int c = 0; c < opt->clients; c++) {
+            long long k = clients[c].count[s] < MAX_SAMPLES ? clients[c].count[s] : MAX_SAMPLES;
+            memcpy(sorted + n, clients[c].samples[s], sizeof(long long) * k);
+            n += k;
+        }
+        if (n == 0) {
+            printf("  %-10s %8d\n", stage_names[s], 0);
+            continue;
+        }
+        qsort(sorted, n, sizeof(long long), compare_ll);
+        long long sum = 0;
+        for (long long i = 0; i < n; i++) sum += sorted[i];
+        printf("  %-10s %8lld %7.2fms %7.2fms %7.2fms %7.2fms %7.2fms\n", stage_names[s], n,
+               ms(sum / n), ms(sorted[n / 2]), ms(sorted[n * 90 / 100]),
+               ms(sorted[n * 99 / 100]), ms(sorted[n - 1]));
+        if (s == STAGE_TOTAL) total_n = n;
+    }
+
+    // sorted 에는 마지막 단계 (total) 가 남아 있음
+    if (total_n > 0) {
+        long long buckets[HIST_BUCKETS] = {0};
+        for (long long i = 0; i < total_n; i++) {
+            int b = 0;
+            while (b < HIST_BUCKETS - 1 && sorted[i] >= (250000LL << b)) b++;
+            buckets[b]++;
+        }
+        printf("\n  total latency\n");
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            if (buckets[b] == 0) continue;
+            int bar = (int)(buckets[b] * 50 / total_n);
+            if (b < HIST_BUCKETS - 1) printf("  < %7.2fms %7lld ", ms(250000LL << b), buckets[b]);
+            else printf("  >=%7.2fms %7lld ", ms(250000LL << (b - 1)), buckets[b]);
+            for (int i = 0; i < bar; i++) putchar('#');
+            putchar('\n');
+        }
+    }
+    free(sorted);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "사용법: %s [-t 틱Hz] [-r 전송Hz] [-k 키/초] [-d 초] [-c 클라이언트] [-s 서버경로] [-l ms] [-P] [-R]\n"
+        "  -t : 서버 틱 주기 (--tick-hz, 기본 %d)\n"
+        "  -r : 클라이언트가 모은 입력을 보내는 주기 (기본 %d)\n"
+        "  -l : 입력을 ms 만큼 늦게 보내고 서버 랙 보정이 되감아 판정했는지 확인 (메트릭 포트 %d)\n"
+        "  -P : 실제 클라이언트처럼 롤백으로 예측해 그림 (입력은 틱마다, 되감는 판정이 거의 없어야 함)\n"
+        "  -R : 화면 그리기 생략 (render 단계 0)\n", prog, DEFAULT_TICK_HZ, DEFAULT_SEND_HZ, METRICS_PORT);
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions opt = { DEFAULT_TICK_HZ, DEFAULT_SEND_HZ, DEFAULT_KEY_HZ, DEFAULT_SECONDS,
+                         DEFAULT_CLIENTS, 1, 0, 0 };
+    char server_path[512];
+    const char* slash = strrchr(argv[0], '/');
+    if (slash != NULL) snprintf(server_path, sizeof(server_path), "%.*s/server", (int)(slash - argv[0]), argv[0]);
+    else snprintf(server_path, sizeof(server_path), "./server");
+
+    int c;
+    while ((c = getopt(argc, argv, "t:r:k:d:c:s:l:PRh")) != -1) {
+        switch (c) {
+            case 't': opt.tick_hz = atoi(optarg); break;
+            case 'r': opt.send_hz = atoi(optarg); break;
+            case 'k': opt.key_hz = atoi(optarg); break;
+            case 'd': opt.seconds = atoi(optarg); break;
+            case 'c': opt.clients = atoi(optarg); break;
+            case 's': snprintf(server_path, sizeof(server_path), "%s", optarg); break;
+            case 'l': opt.lag_ms = atoi(optarg); break;
+            case 'P': opt.predict = 1; break;
+            case 'R': opt.render = 0; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    // 게임은 두 명이 모여야 시작하므로 클라이언트는 정확히 MAX_PLAYERS
+    if (opt.tick_hz <= 0 || opt.send_hz <= 0 || opt.key_hz <= 0 || opt.seconds <= 0 ||
+        opt.clients != MAX_PLAYERS || opt.lag_ms < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    size_t size = sizeof(ClientStats) * opt.clients;
+    ClientStats* clients = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (clients == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    int lag_check = opt.lag_ms > 0 || opt.predict;
+    pid_t server = start_server(server_path, opt.tick_hz, lag_check ? METRICS_PORT : 0);
+    if (server < 0) return 1;
+
+    pid_t pids[MAX_PLAYERS];
+    for (int i = 0; i < opt.clients; i++) {
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            run_client(&opt, i, &clients[i]);
+            _exit(0);
+        }
+    }
+    for (int i = 0; i < opt.clients; i++) {
+        if (pids[i] > 0) waitpid(pids[i], NULL, 0);
+    }
+    // 되감기 횟수는 판이 끝나도 서버에 누적되어 있음
+    long long checks = lag_check ? scrape_metric(METRICS_PORT, "spacewar_lagcomp_checks_total") : 0;
+    long long rewinds = lag_check ? scrape_metric(METRICS_PORT, "spacewar_lagcomp_rewinds_total") : 0;
+    long long rewound = lag_check ? scrape_metric(METRICS_PORT, "spacewar_lagcomp_rewound_ticks_total") : 0;
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+
+    int failed = 0, game_over = 0;
+    for (int i = 0; i < opt.clients; i++) {
+        failed |= clients[i].failed;
+        game_over |= clients[i].game_over;
+    }
+    if (failed) fprintf(stderr, "클라이언트 연결/시작 실패\n");
+    if (game_over) fprintf(stderr, "측정 중 게임이 끝나 일찍 멈춤\n");
+
+    report(&opt, clients);
+    munmap(clients, size);
+
+    int lag_failed = 0;
+    if (lag_check) {
+        printf("\nlagcomp: 입력 지연 %dms (%d틱)%s, 판정 %lld회 중 되감음 %lld회 (평균 %.2f틱)\n",
+               opt.lag_ms, opt.lag_ms * opt.tick_hz / 1000, opt.predict ? ", 롤백 예측" : "",
+               checks, rewinds, checks > 0 ? (double)rewound / checks : 0.0);
+        if (rewinds < 0 || checks < 0 || rewound < 0) {
+            fprintf(stderr, "서버 메트릭을 읽지 못함\n");
+            lag_failed = 1;
+        } else if (opt.predict && rewound > checks * PREDICT_REWIND_MAX) {
+            // 예측한 클라이언트는 서버와 거의 같은 프레임을 그리므로 왕복 지연만큼 되감으면 화면에 없던 화살로 판정함
+            fprintf(stderr, "예측해 그리는 클라이언트를 왕복 지연만큼 되감아 판정함\n");
+            lag_failed = 1;
+        } else if (!opt.predict && rewinds == 0 && opt.lag_ms * opt.tick_hz >= 1000) {
+            // 한 틱 넘게 늦은 입력이면 되감아야 함
+            fprintf(stderr, "늦게 도착한 입력에도 랙 보정이 되감지 않음\n");
+            lag_failed = 1;
+        }
+    }
+    return failed || lag_failed ? 1 : 0;
+}
@@ -1,6 +1,8 @@
 #include "launcher.h"
 #include "menu_ui.h" 
 #include "common.h"
+#include "net.h"
+#include "single_game.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -28,6 +30,7 @@ static void executeGameprocess(const char* program, char* const argv[], const ch
     if (pid == 0) {
         // 자식 프로세스
         setenv("SPACEWAR_SCORE_FILE", temp_file, 1);
+        setenv("SPACEWAR_LOG", LAUNCHER_LOG_PREFIX, 0);     // 화면 뒤 진단은 파일로
         execv(program, argv);
         perror("Failed to execute game");
         exit(1);
@@ -38,7 +41,7 @@ static void executeGameprocess(const char* program, char* const argv[], const ch
     }
 }
 
-// 결과 파일 읽기 및 UI 표시
+// 결과 파일 읽기 및 UI 표시 (별도 프로세스로 돌린 게임)
 void gameResult(const char* temp_file, const char* player_name, const char* mode_str) {
     int finalScore = 0;
 
@@ -49,12 +52,19 @@ void gameResult(const char* temp_file, const char* player_name, const char* mode
     }
     unlink(temp_file);
 
+    showGameResult(finalScore, player_name, mode_str);
+}
+
+// 점수 저장 및 결과창 표시
+void showGameResult(int finalScore, const char* player_name, const char* mode_str) {
     // ncurses 재초기화
     reinitNcurses(); 
 
     if (finalScore > 0) {
-        // 점수 저장
+        // 점수 저장 (리더보드 데몬이 있으면 전체 순위도)
         saveScore(player_name, finalScore, mode_str);
+        int globalRank = 0, globalTotal = 0;
+        int ranked = submitScore(player_name, finalScore, mode_str, &globalRank, &globalTotal);
 
         int max_y, max_x;
         getmaxyx(stdscr, max_y, max_x);
@@ -83,6 +93,9 @@ void gameResult(const char* temp_file, const char* player_name, const char* mode
         wattron(scoreWin, COLOR_PAIR(COLOR_PAIR_ACCENT) | A_BOLD);
         mvwprintw(scoreWin, 5, (win_width - 30) / 2, "Final Score: %d", finalScore);
         mvwprintw(scoreWin, 6, (win_width - 30) / 2, "Score saved!");
+        if (ranked) {
+            mvwprintw(scoreWin, 7, (win_width - 30) / 2, "Global Rank: #%d / %d", globalRank, globalTotal);
+        }
         wattroff(scoreWin, COLOR_PAIR(COLOR_PAIR_ACCENT) | A_BOLD);
         
         wattron(scoreWin, COLOR_PAIR(COLOR_PAIR_STATUS) | A_BLINK);
@@ -100,36 +113,62 @@ void gameResult(const char* temp_file, const char* player_name, const char* mode
 void handleSingleplay(void) {
     char playerName[32];
     getPlayername(playerName, sizeof(playerName));
-    
-    endwin(); // 게임 실행 전 ncurses 종료
-    
-    char tempScorefile[] = "/tmp/spacewar_score_XXXXXX";
-    int scoreFd = mkstemp(tempScorefile);
-    if (scoreFd == -1) {
-        perror("Failed to create temp file");
-        return;
-    }
-    close(scoreFd);
-    
-    char* argv[] = {"single_play", NULL};
-    executeGameprocess("./single_play", argv, tempScorefile, playerName, "SINGLE");
+
+    // 메뉴의 ncurses 화면 위에서 바로 실행 (프로세스 생성, 터미널 재시작, 임시 파일 없음)
+    SingleResult result;
+    single_game_run(&result);
+    showGameResult(result.score, playerName, "SINGLE");
+}
+
+// 서버 시작 실패 안내
+static void showServerError(const char* reason) {
+    int max_y, max_x;
+    getmaxyx(stdscr, max_y, max_x);
+    int win_h = 10, win_w = 50;
+    WINDOW* errWin = newwin(win_h, win_w, (max_y - win_h)/2, (max_x - win_w)/2);
+    wbkgd(errWin, COLOR_PAIR(COLOR_PAIR_NORMAL));
+    box(errWin, 0, 0);
+    wattron(errWin, COLOR_PAIR(COLOR_PAIR_TITLE) | A_BOLD);
+    mvwprintw(errWin, 3, (win_w-22)/2, "Server failed to start");
+    wattroff(errWin, COLOR_PAIR(COLOR_PAIR_TITLE) | A_BOLD);
+    mvwprintw(errWin, 5, 2, "%.*s", win_w - 4, reason);
+    wattron(errWin, COLOR_PAIR(COLOR_PAIR_STATUS) | A_BLINK);
+    mvwprintw(errWin, 7, (win_w-25)/2, "Press any key to continue");
+    wattroff(errWin, COLOR_PAIR(COLOR_PAIR_STATUS) | A_BLINK);
+    wrefresh(errWin);
+    wgetch(errWin);
+    delwin(errWin);
 }
 
 // 멀티플레이 Host 시작
 void handleMultihost(void) {
     char player_name[32];
     getPlayername(player_name, sizeof(player_name));
+
+    // 서버가 listen 에 성공하면 (또는 실패하면) 한 줄 알려주는 파이프
+    int ready[2];
+    if (pipe(ready) == -1) return;
     
     // 서버 프로세스 실행
     server_pid = fork();
     if (server_pid == 0) {
         freopen("/dev/null", "w", stdout);
         freopen("/dev/null", "w", stderr);
-        execl("./server", "server", NULL);
+        // 출력은 버려도 로그는 파일로 남김 (spacewar.server.log)
+        setenv("SPACEWAR_LOG", LAUNCHER_LOG_PREFIX, 0);
+        // 쓰기 끝만 서버에 넘김
+        char ready_fd[16];
+        close(ready[0]);
+        snprintf(ready_fd, sizeof(ready_fd), "%d", ready[1]);
+        setenv(NET_READY_ENV, ready_fd, 1);
+        // SPACEWAR_LOCKSTEP 설정 시 입력만 주고받는 락스텝 모드로 호스트
+        if (getenv("SPACEWAR_LOCKSTEP")) execl("./server", "server", "--lockstep", NULL);
+        else execl("./server", "server", NULL);
         exit(1);
-    } else if (server_pid > 0) {
-        sleep(1); // 서버 켜질 때까지 잠깐 대기
+    }
+    close(ready[1]);    // 서버가 알리기 전에 죽으면 읽기 끝에서 EOF
 
+    if (server_pid > 0) {
         // 서버 대기 UI
         int max_y, max_x;
         getmaxyx(stdscr, max_y, max_x);
@@ -147,6 +186,16 @@ void handleMultihost(void) {
         wrefresh(waitWin);
         delwin(waitWin);
 
+        // 고정 대기 대신 서버의 준비 알림을 기다림 (포트 사용 중 등 실패는 이유와 함께)
+        char reason[256];
+        int started = net_wait_ready(ready[0], NET_READY_TIMEOUT_MS, reason, sizeof(reason));
+        close(ready[0]);
+        if (started != 0) {
+            cleanServer();
+            showServerError(reason);
+            return;
+        }
+
         endwin();
 
         // 임시 파일 생성
@@ -162,6 +211,8 @@ void handleMultihost(void) {
         char* argv[] = {"client", "127.0.0.1", NULL};
         executeGameprocess("./client", argv, temp_score_file, player_name, "MULTI");
         cleanServer(); // 게임 끝나면 서버 끔
+    } else {
+        close(ready[0]);
     }
 }
 
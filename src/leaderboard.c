@@ -0,0 +1,136 @@
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <netdb.h>
+#include "leaderboard.h"
+#include "scoreboard.h"
+#include "net.h"
+#include "codec.h"
+
+void lb_encode_request(unsigned char* buf, int op, int rank, int count, const ScoreEntry* entry) {
+    memset(buf, 0, LB_REQUEST_SIZE);
+    put_le32(buf, op);
+    put_le32(buf + 4, rank);
+    put_le32(buf + 8, count);
+    score_encode_record(buf + 16, entry);
+}
+
+void lb_decode_request(const unsigned char* buf, int* op, int* rank, int* count, ScoreEntry* entry) {
+    *op = (int)get_le32(buf);
+    *rank = (int)get_le32(buf + 4);
+    *count = (int)get_le32(buf + 8);
+    if (score_decode_record(buf + 16, entry) == -1) *op = 0;    // 깨진 요청
+}
+
+void lb_encode_response(unsigned char* buf, int status, int total, int first_rank, int count) {
+    put_le32(buf, status);
+    put_le32(buf + 4, total);
+    put_le32(buf + 8, first_rank);
+    put_le32(buf + 12, count);
+}
+
+const char* lb_address(void) {
+    const char* address = getenv("SPACEWAR_LEADERBOARD");
+    return (address != NULL && address[0] != '\0') ? address : LB_DEFAULT_SOCKET;
+}
+
+// 연결/송수신 모두 LB_TIMEOUT_MS 안에 끝나지 않으면 실패
+static void set_timeout(int fd) {
+    struct timeval tv = { LB_TIMEOUT_MS / 1000, (LB_TIMEOUT_MS % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+static int connect_unix(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) return -1;
+    set_timeout(fd);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int connect_tcp(const char* address) {
+    char host[256];
+    const char* colon = strrchr(address, ':');
+    size_t len = colon - address;
+    if (len == 0 || len >= sizeof(host)) return -1;
+    memcpy(host, address, len);
+    host[len] = '\0';
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, colon + 1, &hints, &res) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo* ai = res; ai != NULL && fd == -1; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd == -1) continue;
+        set_timeout(fd);
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+int lb_connect(const char* address) {
+    return strchr(address, ':') != NULL ? connect_tcp(address) : connect_unix(address);
+}
+
+static int request(int fd, int op, int rank, int count, const ScoreEntry* entry, LbResult* result) {
+    unsigned char buf[LB_REQUEST_SIZE];
+    lb_encode_request(buf, op, rank, count, entry);
+    if (net_write_full(fd, buf, sizeof(buf)) == -1) return -1;
+
+    unsigned char header[LB_RESPONSE_SIZE];
+    if (net_read_full(fd, header, sizeof(header)) == -1) return -1;
+    result->status = (int)get_le32(header);
+    result->total = (int)get_le32(header + 4);
+    result->first_rank = (int)get_le32(header + 8);
+    result->count = (int)get_le32(header + 12);
+    if (result->count < 0 || result->count > LB_MAX_ROWS) return -1;
+
+    for (int i = 0; i < result->count; i++) {
+        unsigned char record[SCORE_RECORD_SIZE];
+        if (net_read_full(fd, record, sizeof(record)) == -1) return -1;
+        if (score_decode_record(record, &result->rows[i]) == -1) return -1;
+    }
+    return 0;
+}
+
+int lb_submit(int fd, const ScoreEntry* entry, LbResult* result) {
+    return request(fd, LB_SUBMIT, 0, 0, entry, result);
+}
+
+int lb_top(int fd, const char* mode, int count, LbResult* result) {
+    ScoreEntry key;
+    score_make_key(&key, NULL, mode);
+    return request(fd, LB_TOP, 1, count, &key, result);
+}
+
+int lb_rank(int fd, const char* name, const char* mode, LbResult* result) {
+    ScoreEntry key;
+    score_make_key(&key, name, mode);
+    return request(fd, LB_RANK, 0, 1, &key, result);
+}
+
+int lb_around(int fd, const char* mode, int rank, int count, LbResult* result) {
+    ScoreEntry key;
+    score_make_key(&key, NULL, mode);
+    return request(fd, LB_AROUND, rank, count, &key, result);
+}
@@ -0,0 +1,406 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+#include "leaderboard.h"
+#include "scoreboard.h"
+#include "ranklist.h"
+#include "net.h"
+#include "timeutil.h"
+
+// 리더보드 데몬
+// 여러 게임 호스트가 보낸 기록을 WAL (점수 파일 v2 형식) 에 먼저 남기고
+// 모드별 순위 스킵 리스트에 플레이어/모드당 최고 기록 하나씩 유지한다.
+// 시작할 때 WAL 을 플레이어/모드별 최고 기록만 남도록 압축한 뒤 다시 읽어 순위를 복원한다.
+
+#define MAX_BOARDS  8
+#define MAX_CLIENTS 64
+#define PLAYER_TABLE_INIT 1024
+#define CLIENT_TIMEOUT_MS 1000  // 요청을 보내다 멈춘 클라이언트는 끊음
+#define MAX_CLOCK_SKEW_SEC 86400 // 지금과 이보다 차이 나는 시각의 기록은 거절 (판이 끝날 때 바로 제출하므로)
+
+// 클라이언트 연결 (소켓은 논블로킹, poll 이 알려 준 만큼만 읽어 요청 하나가 찰 때까지 모음)
+typedef struct {
+    unsigned char buf[LB_REQUEST_SIZE];
+    size_t have;
+    long long started_ns;       // 요청 첫 바이트를 받은 시각
+} Conn;
+
+// 모드별 순위
+typedef struct {
+    char mode[10];
+    RankList list;
+} Board;
+
+// 플레이어/모드별 최고 기록 (이름/모드 뒤쪽은 0 으로 채워져 있어 배열 전체로 비교)
+typedef struct {
+    int used;
+    ScoreEntry best;
+} PlayerSlot;
+
+static Board boards[MAX_BOARDS];
+static int board_count = 0;
+
+static PlayerSlot* players = NULL;
+static int player_capacity = 0;
+static int player_count = 0;
+
+static int wal_fd = -1;
+static volatile sig_atomic_t running = 1;
+
+static void on_signal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+static Board* find_board(const char* mode, int create) {
+    for (int i = 0; i < board_count; i++) {
+        if (strncmp(boards[i].mode, mode, sizeof(boards[i].mode)) == 0) return &boards[i];
+    }
+    if (!create || board_count == MAX_BOARDS) return NULL;
+
+    Board* board = &boards[board_count];
+    memset(board->mode, 0, sizeof(board->mode));
+    memcpy(board->mode, mode, strnlen(mode, sizeof(board->mode) - 1));
+    if (rank_init(&board->list, (unsigned int)time(NULL) + board_count) != 0) return NULL;
+    board_count++;
+    return board;
+}
+
+static PlayerSlot* player_slot(PlayerSlot* table, int capacity, const ScoreEntry* key) {
+    unsigned int i = score_key_hash(key) & (capacity - 1);
+    while (table[i].used && !score_key_equal(&table[i].best, key)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &table[i];
+}
+
+static int player_grow(void) {
+    int capacity = player_capacity ? player_capacity * 2 : PLAYER_TABLE_INIT;
+    PlayerSlot* table = calloc(capacity, sizeof(PlayerSlot));
+    if (table == NULL) return -1;
+    for (int i = 0; i < player_capacity; i++) {
+        if (players[i].used) *player_slot(table, capacity, &players[i].best) = players[i];
+    }
+    free(players);
+    players = table;
+    player_capacity = capacity;
+    return 0;
+}
+
+// 이름/모드 뒤쪽을 0 으로 맞춘 키
+static void normalize(ScoreEntry* entry) {
+    ScoreEntry key;
+    score_make_key(&key, entry->name, entry->mode);
+    key.score = entry->score;
+    key.timestamp = entry->timestamp;
+    *entry = key;
+}
+
+// 기록 하나를 반영할 자리 확보: 모드 순위를 찾거나 만들고 플레이어 표에 빈 칸을 남김 (실패 시 NULL)
+// WAL 에 남기기 전에 불러서 반영하지 못할 기록이 재시작 때 되살아나지 않게 함
+static Board* reserve(const ScoreEntry* entry) {
+    Board* board = find_board(entry->mode, 1);
+    if (board == NULL) return NULL;
+    if ((player_count + 1) * 10 > player_capacity * 7 && player_grow() != 0) return NULL;
+    return board;
+}
+
+// 최고 기록보다 앞서면 순위 갱신 (compareScores 순서, WAL 압축과 같은 기준)
+// 순위에 있는 그 플레이어의 기록 반환 (실패 시 NULL)
+static const ScoreEntry* apply(const ScoreEntry* entry) {
+    Board* board = reserve(entry);
+    if (board == NULL) return NULL;
+
+    PlayerSlot* slot = player_slot(players, player_capacity, entry);
+    if (slot->used) {
+        if (compareScores(entry, &slot->best) >= 0) return &slot->best;
+        rank_remove(&board->list, &slot->best);
+    } else {
+        slot->used = 1;
+        player_count++;
+    }
+    slot->best = *entry;
+    if (rank_insert(&board->list, entry) != 0) return NULL;
+    return &slot->best;
+}
+
+// WAL 에 먼저 남기고 디스크에 내려간 뒤에만 반영
+static int wal_append(const ScoreEntry* entry) {
+    unsigned char record[SCORE_RECORD_SIZE];
+    score_encode_record(record, entry);
+    if (write(wal_fd, record, sizeof(record)) != (ssize_t)sizeof(record)) return -1;
+    return fdatasync(wal_fd);
+}
+
+static int wal_replay(const char* path) {
+    // 한 번 압축하고 나면 플레이어/모드당 기록 하나만 남음
+    if (score_compact_needed(path)) {
+        long long removed = score_compact(path, 1);
+        if (removed > 0) printf("WAL 압축: 기록 %lld개 정리\n", removed);
+    }
+
+    ScoreMap map;
+    if (score_map_open(path, &map) == -1) return -1;
+    long long applied = 0, corrupt = 0;
+    for (long long i = 0; i < map.count; i++) {
+        ScoreEntry entry;
+        if (score_map_get(&map, i, &entry) != 0) {
+            corrupt++;
+            continue;
+        }
+        normalize(&entry);
+        if (apply(&entry) != NULL) applied++;
+    }
+    score_map_close(&map);
+
+    printf("WAL 복원: 기록 %lld개, 플레이어 %d명, 모드 %d개", applied, player_count, board_count);
+    if (corrupt > 0) printf(" (깨진 기록 %lld개 건너뜀)", corrupt);
+    printf("\n");
+
+    wal_fd = score_open_append(path);
+    return wal_fd == -1 ? -1 : 0;
+}
+
+// 응답 헤더 + rank 부터 count 개
+static int send_rows(int fd, int status, const Board* board, int rank, int count) {
+    int total = board ? board->list.length : 0;
+    const RankNode* node = board ? rank_at(&board->list, rank) : NULL;
+    if (node == NULL) count = 0;
+    if (count > total - rank + 1) count = total - rank + 1;
+    if (count < 0) count = 0;
+
+    unsigned char buf[LB_RESPONSE_SIZE + LB_MAX_ROWS * SCORE_RECORD_SIZE];
+    lb_encode_response(buf, status, total, count > 0 ? rank : 0, count);
+    for (int i = 0; i < count; i++, node = node->link[0].next) {
+        score_encode_record(buf + LB_RESPONSE_SIZE + i * SCORE_RECORD_SIZE, &node->entry);
+    }
+    return net_write_full(fd, buf, LB_RESPONSE_SIZE + (size_t)count * SCORE_RECORD_SIZE);
+}
+
+static int send_status(int fd, int status) {
+    unsigned char buf[LB_RESPONSE_SIZE];
+    lb_encode_response(buf, status, 0, 0, 0);
+    return net_write_full(fd, buf, sizeof(buf));
+}
+
+static int handle_request(int fd, const unsigned char* buf) {
+    int op, rank, count;
+    ScoreEntry entry;
+    lb_decode_request(buf, &op, &rank, &count, &entry);
+    normalize(&entry);
+    if (count < 1) count = 1;
+    if (count > LB_MAX_ROWS) count = LB_MAX_ROWS;
+
+    Board* board = find_board(entry.mode, 0);
+    switch (op) {
+        case LB_SUBMIT: {
+            if (entry.name[0] == '\0' || entry.mode[0] == '\0') return send_status(fd, LB_BAD_REQUEST);
+            // 시각은 같은 점수끼리의 순서이므로 먼 미래 시각으로 순위를 고정하지 못하게 함
+            time_t now = time(NULL);
+            if (entry.timestamp < now - MAX_CLOCK_SKEW_SEC || entry.timestamp > now + MAX_CLOCK_SKEW_SEC) {
+                return send_status(fd, LB_BAD_REQUEST);
+            }
+            if (reserve(&entry) == NULL || wal_append(&entry) != 0) return send_status(fd, LB_ERROR);
+            const ScoreEntry* best = apply(&entry);
+            if (best == NULL) return send_status(fd, LB_ERROR);
+            board = find_board(entry.mode, 0);
+            return send_rows(fd, LB_OK, board, rank_of(&board->list, best), 1);
+        }
+        case LB_TOP:
+            return send_rows(fd, LB_OK, board, 1, count);
+        case LB_RANK: {
+            PlayerSlot* slot = players ? player_slot(players, player_capacity, &entry) : NULL;
+            if (board == NULL || slot == NULL || !slot->used) return send_status(fd, LB_NOT_FOUND);
+            return send_rows(fd, LB_OK, board, rank_of(&board->list, &slot->best), 1);
+        }
+        case LB_AROUND: {
+            if (board == NULL) return send_rows(fd, LB_OK, NULL, 1, 0);
+            // rank 를 가운데에 두되 끝에서는 창을 안쪽으로 밀어 count 개를 채움
+            int first = rank - count / 2;
+            if (first + count - 1 > board->list.length) first = board->list.length - count + 1;
+            if (first < 1) first = 1;
+            return send_rows(fd, LB_OK, board, first, count);
+        }
+        default:
+            return send_status(fd, LB_BAD_REQUEST);
+    }
+}
+
+// 읽을 수 있는 만큼 받고 요청이 다 차면 처리 (연결을 닫아야 하면 -1)
+// 응답은 몇 KB 라 소켓 버퍼에 바로 들어감, 응답을 읽지 않고 요청만 쌓는 클라이언트는 쓰기 실패로 끊김
+static int handle_readable(int fd, Conn* conn) {
+    ssize_t n = recv(fd, conn->buf + conn->have, sizeof(conn->buf) - conn->have, 0);
+    if (n == 0) return -1;
+    if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+
+    if (conn->have == 0) conn->started_ns = now_ns();
+    conn->have += (size_t)n;
+    if (conn->have < sizeof(conn->buf)) return 0;
+    conn->have = 0;
+    return handle_request(fd, conn->buf);
+}
+
+static int listen_unix(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) return -1;
+
+    // 살아 있는 데몬이 있으면 그대로 두고, 남은 소켓 파일만 지움
+    int probe = lb_connect(path);
+    if (probe != -1) {
+        close(probe);
+        close(fd);
+        errno = EADDRINUSE;
+        return -1;
+    }
+    unlink(path);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(fd, 16) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listen_tcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1) return -1;
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(fd, 16) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    const char* socket_path = LB_DEFAULT_SOCKET;
+    const char* wal_path = LB_DEFAULT_WAL;
+    int port = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) socket_path = argv[++i];
+        else if (strcmp(argv[i], "--wal") == 0 && i + 1 < argc) wal_path = argv[++i];
+        else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "사용법: %s [--socket 경로] [--port 포트] [--wal 경로]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (player_grow() != 0 || wal_replay(wal_path) != 0) {
+        perror("WAL 열기 실패");
+        return 1;
+    }
+
+    struct pollfd fds[2 + MAX_CLIENTS];
+    Conn conns[2 + MAX_CLIENTS];        // fds 와 같은 자리 (리스너 자리는 쓰지 않음)
+    int listeners = 0;
+    fds[listeners].fd = listen_unix(socket_path);
+    if (fds[listeners].fd == -1) {
+        perror("소켓 열기 실패");
+        return 1;
+    }
+    printf("리더보드 시작 %s", socket_path);
+    listeners++;
+
+    if (port > 0) {
+        fds[listeners].fd = listen_tcp(port);
+        if (fds[listeners].fd == -1) {
+            perror("포트 열기 실패");
+            unlink(socket_path);
+            return 1;
+        }
+        printf(", 포트 %d", port);
+        listeners++;
+    }
+    printf(" (WAL %s)\n", wal_path);
+    fflush(stdout);
+
+    int nfds = listeners;
+    for (int i = 0; i < listeners; i++) fds[i].events = POLLIN;
+
+    while (running) {
+        // 요청을 보내다 만 클라이언트가 있으면 시간 초과를 확인할 수 있게 깨어남
+        int timeout = -1;
+        for (int i = listeners; i < nfds && timeout == -1; i++) {
+            if (conns[i].have > 0) timeout = CLIENT_TIMEOUT_MS / 4;
+        }
+        if (poll(fds, nfds, timeout) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        // 요청 처리 (연결을 끊은 클라이언트는 마지막 것과 자리를 바꿔 제거)
+        long long now = now_ns();
+        for (int i = listeners; i < nfds; i++) {
+            int drop;
+            if (fds[i].revents & POLLIN) drop = handle_readable(fds[i].fd, &conns[i]) != 0;
+            else if (fds[i].revents != 0) drop = 1;
+            else drop = conns[i].have > 0 && now - conns[i].started_ns > CLIENT_TIMEOUT_MS * 1000000LL;
+            if (drop) {
+                close(fds[i].fd);
+                nfds--;
+                fds[i] = fds[nfds];
+                conns[i--] = conns[nfds];
+            }
+        }
+
+        for (int i = 0; i < listeners; i++) {
+            if ((fds[i].revents & POLLIN) == 0) continue;
+            int client = accept(fds[i].fd, NULL, NULL);
+            if (client < 0) continue;
+            if (nfds == 2 + MAX_CLIENTS) {
+                close(client);
+                continue;
+            }
+            if (fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK) == -1) {
+                close(client);
+                continue;
+            }
+            fds[nfds].fd = client;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            conns[nfds].have = 0;
+            nfds++;
+        }
+    }
+
+    for (int i = 0; i < nfds; i++) close(fds[i].fd);
+    unlink(socket_path);
+    close(wal_fd);
+    for (int i = 0; i < board_count; i++) rank_free(&boards[i].list);
+    free(players);
+    printf("리더보드 종료\n");
+    return 0;
+}
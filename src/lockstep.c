@@ -0,0 +1,81 @@
+#include "lockstep.h"
+#include "game_logic.h"
+#include "item.h"
+#include "net.h"
+#include <string.h>
+#include <arpa/inet.h>
+
+// 같은 시드/설정에서 같은 입력을 같은 순서로 적용하면 모든 피어의 상태가 같아짐
+
+static LockstepInput* slot(Lockstep* ls, int frame, int id) {
+    return &ls->input[frame % LOCKSTEP_WINDOW][id];
+}
+
+void lockstep_init(Lockstep* ls, int delay) {
+    memset(ls, 0, sizeof(Lockstep));
+    ls->delay = delay;
+
+    for (int f = 0; f < LOCKSTEP_WINDOW; f++) {
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            ls->input[f][i].frame = -1;
+        }
+    }
+
+    // 지연 구간의 처음 프레임들은 빈 입력
+    for (int f = 0; f < delay; f++) {
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            LockstepInput* in = slot(ls, f, i);
+            in->frame = f;
+            in->id = (uint8_t)i;
+        }
+    }
+}
+
+int lockstep_add(Lockstep* ls, const LockstepInput* input, int current_frame) {
+    if (input->id >= MAX_PLAYERS) return -1;
+    // 지난 프레임이나 창 밖 프레임은 아직 쓰는 칸을 덮어쓰므로 버림
+    if (input->frame < current_frame || input->frame >= current_frame + LOCKSTEP_WINDOW) return -1;
+    *slot(ls, input->frame, input->id) = *input;
+    return 0;
+}
+
+// state->frame 을 진행할 입력이 모든 플레이어에게서 도착했는지
+int lockstep_ready(const Lockstep* ls, const GameState* state) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (!state->player[i].connected) continue;
+        if (ls->input[state->frame % LOCKSTEP_WINDOW][i].frame != state->frame) return 0;
+    }
+    return 1;
+}
+
+// 모인 입력을 플레이어 ID 순서로 적용하고 한 틱 진행
+void lockstep_advance(Lockstep* ls, GameState* state) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Player* player = &state->player[i];
+        const LockstepInput* in = slot(ls, state->frame, i);
+        if (!player->connected || in->frame != state->frame) continue;
+
+        move_player(player, in->dx, in->dy);
+        switch (in->item) {
+            case 1: invincible_item(player, &state->config); break;
+            case 2: heal_item(player); break;
+            case 3: slow_item(player, &state->config); break;
+        }
+    }
+
+    update_game(state, GAME_WIDTH, GAME_HEIGHT);
+    update_events(state, GAME_WIDTH, GAME_HEIGHT);
+    ls->frames++;
+}
+
+int lockstep_send(int fd, const LockstepInput* input) {
+    LockstepInput wire = *input;
+    wire.frame = (int32_t)htonl((uint32_t)input->frame);
+    return net_write_full(fd, &wire, sizeof(wire));
+}
+
+int lockstep_recv(int fd, LockstepInput* input) {
+    if (net_read_full(fd, input, sizeof(LockstepInput)) != 0) return -1;
+    input->frame = (int32_t)ntohl((uint32_t)input->frame);
+    return 0;
+}
@@ -0,0 +1,322 @@
+#include "logger.h"
+#include "ring.h"
+#include "timeutil.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#define LOG_BATCH 1024          // 기록 스레드가 한 번에 모아 정렬하는 줄 수
+
+// 스레드 링에 넣는 고정 크기 레코드 (포맷은 호출한 스레드, 시각/위치 붙이기와 쓰기는 기록 스레드)
+typedef struct {
+    long long ts_ns;            // CLOCK_REALTIME
+    const LogSite* site;
+    const char* thread;
+    int level;
+    int suppressed;
+    char msg[LOG_MSG_SIZE];
+} LogRecord;
+
+// 스레드별 링 (생산자: 소유 스레드, 소비자: 기록 스레드)
+typedef struct {
+    Ring ring;
+    const char* name;
+    int in_use;                 // 살아 있는 스레드가 쓰는 중
+} LogBuffer;
+
+atomic_int log_level = LOG_INFO;
+LogStats log_stats;
+
+static LogBuffer* buffers[LOG_MAX_THREADS];
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t buffer_key;
+static __thread LogBuffer* local = NULL;
+static __thread int local_full = 0;     // 슬롯이 없어 기록 스레드를 거치지 못하는 스레드
+
+static int started = 0;
+static int base_level = LOG_INFO;       // 시그널로 debug 를 껐을 때 돌아갈 수준
+static atomic_int stopping;
+static sem_t wake;
+static pthread_t writer_thread;
+
+static FILE* out = NULL;
+static char log_path[PATH_MAX];         // 비어 있으면 표준 에러 (회전 없음)
+static long long out_bytes = 0;
+
+static const char* level_names[LOG_LEVELS] = { "debug", "info", "warn", "error" };
+static const char* level_tags[LOG_LEVELS] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+int log_parse_level(const char* name) {
+    for (int i = 0; i < LOG_LEVELS; i++) {
+        if (strcmp(name, level_names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+const char* log_level_name(LogLevel level) {
+    return (level >= 0 && level < LOG_LEVELS) ? level_names[level] : "?";
+}
+
+// =========================================================
+// 스레드 링 등록 (trace.c 와 같은 방식)
+// =========================================================
+
+// 스레드 종료 시 슬롯 반납 (남은 줄은 기록 스레드가 마저 씀)
+static void release_buffer(void* arg) {
+    LogBuffer* buffer = (LogBuffer*)arg;
+    pthread_mutex_lock(&registry_mutex);
+    buffer->in_use = 0;
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+static LogBuffer* acquire_buffer(const char* name) {
+    LogBuffer* found = NULL;
+
+    pthread_mutex_lock(&registry_mutex);
+    for (int i = 0; i < LOG_MAX_THREADS && found == NULL; i++) {
+        if (buffers[i] == NULL) {
+            LogBuffer* buffer = calloc(1, sizeof(LogBuffer));
+            if (buffer == NULL) break;
+            if (ring_init(&buffer->ring, sizeof(LogRecord), LOG_RING_RECORDS) != 0) {
+                free(buffer);
+                break;
+            }
+            buffers[i] = buffer;
+            found = buffer;
+        }
+    }
+    for (int i = 0; i < LOG_MAX_THREADS && found == NULL && buffers[i] != NULL; i++) {
+        if (!buffers[i]->in_use) found = buffers[i];
+    }
+    if (found != NULL) {
+        found->name = name;
+        found->in_use = 1;
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    if (found != NULL) pthread_setspecific(buffer_key, found);
+    return found;
+}
+
+void log_thread(const char* name) {
+    if (!started) return;
+    if (local != NULL) {
+        local->name = name;
+        return;
+    }
+    local = acquire_buffer(name);
+    local_full = (local == NULL);
+}
+
+// =========================================================
+// 출력 (기록 스레드, 또는 기록 스레드가 없을 때 호출한 스레드)
+// =========================================================
+
+static void open_output(void) {
+    out = NULL;
+    out_bytes = 0;
+    if (log_path[0] != '\0') {
+        out = fopen(log_path, "a");
+        if (out != NULL) out_bytes = ftell(out);
+    }
+    if (out == NULL) out = stderr;
+}
+
+// <파일>.k -> <파일>.k+1 로 한 칸씩 밀고 새 파일을 염
+static void rotate_output(void) {
+    char from[PATH_MAX + 16], to[PATH_MAX + 16];
+
+    fclose(out);
+    for (int k = LOG_KEEP - 1; k >= 0; k--) {
+        if (k == 0) snprintf(from, sizeof(from), "%s", log_path);
+        else snprintf(from, sizeof(from), "%s.%d", log_path, k);
+        snprintf(to, sizeof(to), "%s.%d", log_path, k + 1);
+        rename(from, to);
+    }
+    open_output();
+}
+
+static void write_line(FILE* fp, const LogRecord* record) {
+    char when[32];
+    time_t sec = (time_t)(record->ts_ns / 1000000000LL);
+    struct tm tm;
+    localtime_r(&sec, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+
+    const char* file = record->site->file;
+    const char* slash = strrchr(file, '/');
+    if (slash != NULL) file = slash + 1;
+
+    int n = fprintf(fp, "%s.%03lld %s %-6s %s:%d %s", when, record->ts_ns / 1000000 % 1000,
+                    level_tags[record->level], record->thread, file, record->site->line, record->msg);
+    if (record->suppressed > 0) n += fprintf(fp, " (이 위치에서 %d줄 생략)", record->suppressed);
+    n += fprintf(fp, "\n");
+    if (n > 0) out_bytes += n;
+}
+
+static int compare_records(const void* a, const void* b) {
+    long long ta = ((const LogRecord*)a)->ts_ns;
+    long long tb = ((const LogRecord*)b)->ts_ns;
+    return (ta > tb) - (ta < tb);
+}
+
+// 모든 스레드 링에서 모아 시각 순으로 씀, 쓴 줄 수 반환
+static int drain(void) {
+    static LogRecord batch[LOG_BATCH];
+    int count = 0;
+
+    pthread_mutex_lock(&registry_mutex);
+    for (int t = 0; t < LOG_MAX_THREADS && buffers[t] != NULL; t++) {
+        while (count < LOG_BATCH && ring_pop(&buffers[t]->ring, &batch[count]) == 0) count++;
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    if (count == 0) return 0;
+    qsort(batch, count, sizeof(LogRecord), compare_records);
+    for (int i = 0; i < count; i++) write_line(out, &batch[i]);
+    fflush(out);
+
+    if (out != stderr && out_bytes > LOG_ROTATE_BYTES) rotate_output();
+    return count;
+}
+
+static void* writer_main(void* arg) {
+    (void)arg;
+    long long dropped_seen = 0;
+
+    for (;;) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        long long ns = ts.tv_nsec + LOG_FLUSH_MS * 1000000LL;
+        ts.tv_sec += ns / 1000000000LL;
+        ts.tv_nsec = ns % 1000000000LL;
+        while (sem_timedwait(&wake, &ts) == -1 && errno == EINTR) {}
+        int stop = atomic_load(&stopping);
+
+        while (drain() == LOG_BATCH) {}
+
+        long long dropped = atomic_load(&log_stats.dropped);
+        if (dropped != dropped_seen) {
+            fprintf(out, "로그 링이 가득 차 %lld줄 버림\n", dropped - dropped_seen);
+            fflush(out);
+            dropped_seen = dropped;
+        }
+        if (stop) break;
+    }
+
+    if (out != stderr) fclose(out);
+    out = stderr;
+    return NULL;
+}
+
+// =========================================================
+// 기록
+// =========================================================
+
+// 호출 위치별 초당 LOG_RATE_PER_SEC 줄까지 (여러 스레드가 동시에 부르면 조금 넘을 수 있음)
+static int rate_allow(LogSite* site, long long now) {
+    long long second = now / 1000000000LL;
+    long long window = atomic_load_explicit(&site->window, memory_order_relaxed);
+    if (window != second &&
+        atomic_compare_exchange_strong_explicit(&site->window, &window, second,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        atomic_store_explicit(&site->count, 0, memory_order_relaxed);
+    }
+    if (atomic_fetch_add_explicit(&site->count, 1, memory_order_relaxed) < LOG_RATE_PER_SEC) return 1;
+
+    atomic_fetch_add_explicit(&site->suppressed, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&log_stats.suppressed, 1, memory_order_relaxed);
+    return 0;
+}
+
+void log_write(LogSite* site, LogLevel level, const char* fmt, ...) {
+    LogRecord record;
+    record.ts_ns = realtime_ns();
+    if (!rate_allow(site, record.ts_ns)) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(record.msg, sizeof(record.msg), fmt, ap);
+    va_end(ap);
+    record.site = site;
+    record.level = level;
+    record.suppressed = atomic_exchange_explicit(&site->suppressed, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&log_stats.records[level], 1, memory_order_relaxed);
+
+    if (started && local == NULL && !local_full) log_thread("thread");
+    if (!started || local == NULL) {
+        // 기록 스레드가 없으면 (초기화 전, 슬롯 부족) 바로 씀
+        record.thread = "-";
+        write_line(stderr, &record);
+        return;
+    }
+
+    record.thread = local->name;
+    if (ring_push(&local->ring, &record) != 0) {
+        atomic_fetch_add_explicit(&log_stats.dropped, 1, memory_order_relaxed);
+        return;
+    }
+    if (level >= LOG_WARN) sem_post(&wake);
+}
+
+// =========================================================
+// 설정
+// =========================================================
+
+void log_set_level(LogLevel level) {
+    base_level = level;
+    atomic_store(&log_level, level);
+}
+
+static void on_toggle(int sig) {
+    (void)sig;
+    atomic_store(&log_level, atomic_load(&log_level) == LOG_DEBUG ? base_level : LOG_DEBUG);
+}
+
+void log_toggle_signal(int sig) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_toggle;
+    sa.sa_flags = SA_RESTART;
+    sigaction(sig, &sa, NULL);
+}
+
+void log_init_env(const char* process) {
+    if (started) return;
+
+    const char* level = getenv("SPACEWAR_LOG_LEVEL");
+    if (level != NULL && log_parse_level(level) >= 0) log_set_level(log_parse_level(level));
+
+    const char* prefix = getenv("SPACEWAR_LOG");
+    log_path[0] = '\0';
+    if (prefix != NULL && prefix[0] != '\0') {
+        snprintf(log_path, sizeof(log_path), "%s.%s.log", prefix, process);
+    }
+    open_output();
+
+    pthread_key_create(&buffer_key, release_buffer);
+    atomic_init(&stopping, 0);
+    if (sem_init(&wake, 0, 0) != 0) return;
+    if (pthread_create(&writer_thread, NULL, writer_main, NULL) != 0) {
+        sem_destroy(&wake);
+        return;
+    }
+    started = 1;
+    atexit(log_stop);
+}
+
+void log_stop(void) {
+    if (!started) return;
+    atomic_store(&stopping, 1);
+    sem_post(&wake);
+    pthread_join(writer_thread, NULL);
+    started = 0;
+}
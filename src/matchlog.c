@@ -0,0 +1,336 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "matchlog.h"
+#include "ring.h"
+#include "codec.h"
+#include "timeutil.h"
+
+#define MATCHLOG_FILE_MODE 0644
+
+MatchLogStats matchlog_stats;
+
+static Ring queue;                  // 생산자: 틱 스레드, 소비자: 기록 스레드
+static sem_t wake;                  // 레코드가 들어왔거나 종료 요청 (sem_post 는 막히지 않음)
+static atomic_int stopping;
+static int started = 0;
+static pthread_t writer_thread;
+
+static char log_path[PATH_MAX];
+static int log_fd = -1;
+static long long log_size = 0;
+
+static const char match_magic[4] = { 'S', 'W', 'M', 'H' };
+
+// =========================================================
+// 레코드
+// =========================================================
+
+#define PLAYER_OFFSET 76
+#define PLAYER_SIZE   40
+#define CRC_OFFSET    (MATCHLOG_RECORD_SIZE - 4)
+
+void matchlog_encode(unsigned char* p, const MatchRecord* r) {
+    memset(p, 0, MATCHLOG_RECORD_SIZE);
+    memcpy(p, match_magic, sizeof(match_magic));
+    put_le32(p + 4, MATCHLOG_VERSION);
+    put_le64(p + 8, (uint64_t)r->started);
+    put_le32(p + 16, r->duration_ms);
+    put_le32(p + 20, r->frames);
+    put_le32(p + 24, r->tick_hz);
+    put_le32(p + 28, (uint32_t)r->winner);
+    put_le32(p + 32, r->flags);
+    put_le32(p + 36, r->ticks);
+    put_le32(p + 40, r->tick_mean_ns);
+    put_le32(p + 44, r->tick_max_ns);
+    put_le32(p + 48, r->tick_overruns);
+    put_le32(p + 52, r->arrows_spawned);
+    put_le32(p + 56, r->spawn_drops);
+    for (int s = 0; s < DAMAGE_SOURCES; s++) put_le32(p + 60 + 4 * s, r->damage[s]);
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        const MatchPlayer* mp = &r->player[i];
+        unsigned char* q = p + PLAYER_OFFSET + PLAYER_SIZE * i;
+        put_le32(q, mp->flags);
+        put_le32(q + 4, mp->lives);
+        put_le32(q + 8, mp->score);
+        put_le32(q + 12, mp->alive_ticks);
+        put_le32(q + 16, mp->hits);
+        for (int k = 0; k < 3; k++) put_le32(q + 20 + 4 * k, mp->items_used[k]);
+        put_le32(q + 32, mp->moves);
+        put_le32(q + 36, mp->input_drops);
+    }
+    put_le32(p + CRC_OFFSET, crc32(p, CRC_OFFSET));
+}
+
+int matchlog_decode(const unsigned char* p, MatchRecord* r) {
+    if (memcmp(p, match_magic, sizeof(match_magic)) != 0 ||
+        get_le32(p + 4) != MATCHLOG_VERSION ||
+        get_le32(p + CRC_OFFSET) != crc32(p, CRC_OFFSET)) return -1;
+
+    r->started = (long long)get_le64(p + 8);
+    r->duration_ms = (int)get_le32(p + 16);
+    r->frames = (int)get_le32(p + 20);
+    r->tick_hz = (int)get_le32(p + 24);
+    r->winner = (int)get_le32(p + 28);
+    r->flags = (int)get_le32(p + 32);
+    r->ticks = (int)get_le32(p + 36);
+    r->tick_mean_ns = (int)get_le32(p + 40);
+    r->tick_max_ns = (int)get_le32(p + 44);
+    r->tick_overruns = (int)get_le32(p + 48);
+    r->arrows_spawned = (int)get_le32(p + 52);
+    r->spawn_drops = (int)get_le32(p + 56);
+    for (int s = 0; s < DAMAGE_SOURCES; s++) r->damage[s] = (int)get_le32(p + 60 + 4 * s);
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        MatchPlayer* mp = &r->player[i];
+        const unsigned char* q = p + PLAYER_OFFSET + PLAYER_SIZE * i;
+        mp->flags = (int)get_le32(q);
+        mp->lives = (int)get_le32(q + 4);
+        mp->score = (int)get_le32(q + 8);
+        mp->alive_ticks = (int)get_le32(q + 12);
+        mp->hits = (int)get_le32(q + 16);
+        for (int k = 0; k < 3; k++) mp->items_used[k] = (int)get_le32(q + 20 + 4 * k);
+        mp->moves = (int)get_le32(q + 32);
+        mp->input_drops = (int)get_le32(q + 36);
+    }
+    return 0;
+}
+
+// =========================================================
+// 파일 (기록 스레드 전용)
+// =========================================================
+
+static void rotated_path(char* out, size_t size, const char* path, int k) {
+    if (k == 0) snprintf(out, size, "%s", path);
+    else snprintf(out, size, "%s.%d", path, k);
+}
+
+// 이어 쓸 파일 열기 (이전 실행이 레코드 중간에 죽었으면 잘린 꼬리를 버림)
+static int open_log(void) {
+    log_fd = open(log_path, O_WRONLY | O_CREAT | O_APPEND, MATCHLOG_FILE_MODE);
+    if (log_fd == -1) return -1;
+
+    off_t end = lseek(log_fd, 0, SEEK_END);
+    if (end < 0) end = 0;
+    log_size = end - end % MATCHLOG_RECORD_SIZE;
+    if (log_size != end && ftruncate(log_fd, log_size) == -1) {
+        close(log_fd);
+        log_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static void sync_log(void) {
+    if (log_fd == -1) return;
+    long long start = now_ns();
+    fdatasync(log_fd);
+    atomic_fetch_add_explicit(&matchlog_stats.syncs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&matchlog_stats.sync_ns, now_ns() - start, memory_order_relaxed);
+}
+
+// <경로>.k -> <경로>.k+1 로 한 칸씩 밀고 새 파일을 염 (가장 오래된 파일은 덮어씀)
+static int rotate_log(void) {
+    char from[PATH_MAX + 16], to[PATH_MAX + 16];
+
+    sync_log();
+    close(log_fd);
+    log_fd = -1;
+
+    for (int k = MATCHLOG_KEEP - 1; k >= 0; k--) {
+        rotated_path(from, sizeof(from), log_path, k);
+        rotated_path(to, sizeof(to), log_path, k + 1);
+        rename(from, to);
+    }
+    atomic_fetch_add_explicit(&matchlog_stats.rotations, 1, memory_order_relaxed);
+    return open_log();
+}
+
+static void write_batch(const unsigned char* buf, int count) {
+    size_t len = (size_t)count * MATCHLOG_RECORD_SIZE;
+
+    if (log_fd == -1 && open_log() == -1) {
+        atomic_fetch_add_explicit(&matchlog_stats.failed, count, memory_order_relaxed);
+        return;
+    }
+    if (log_size > 0 && log_size + (long long)len > MATCHLOG_ROTATE_BYTES && rotate_log() == -1) {
+        atomic_fetch_add_explicit(&matchlog_stats.failed, count, memory_order_relaxed);
+        return;
+    }
+
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = write(log_fd, buf + done, len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += (size_t)n;
+    }
+    log_size += done;
+    atomic_fetch_add_explicit(&matchlog_stats.written, done / MATCHLOG_RECORD_SIZE, memory_order_relaxed);
+
+    if (done < len) {
+        // 잘린 레코드는 다음에 열 때 버려지도록 파일을 닫고 다시 염
+        atomic_fetch_add_explicit(&matchlog_stats.failed, count - done / MATCHLOG_RECORD_SIZE,
+                                  memory_order_relaxed);
+        close(log_fd);
+        log_fd = -1;
+    }
+}
+
+// =========================================================
+// 기록 스레드
+// =========================================================
+
+// 쓴 레코드는 MATCHLOG_SYNC_MS 안에 (또는 MATCHLOG_SYNC_RECORDS 개가 쌓이면 바로) 한 번에 내림
+static void* writer_main(void* arg) {
+    (void)arg;
+    static unsigned char batch[MATCHLOG_QUEUE * MATCHLOG_RECORD_SIZE];
+    int unsynced = 0;
+    long long first_unsynced = 0;
+
+    for (;;) {
+        if (unsynced == 0) {
+            while (sem_wait(&wake) == -1 && errno == EINTR) {}
+        } else {
+            long long left = first_unsynced + MATCHLOG_SYNC_MS * 1000000LL - now_ns();
+            if (left > 0) {
+                struct timespec ts;
+                clock_gettime(CLOCK_REALTIME, &ts);
+                long long ns = ts.tv_nsec + left;
+                ts.tv_sec += ns / 1000000000LL;
+                ts.tv_nsec = ns % 1000000000LL;
+                while (sem_timedwait(&wake, &ts) == -1 && errno == EINTR) {}
+            }
+        }
+        int stop = atomic_load(&stopping);
+
+        MatchRecord record;
+        int count = 0;
+        while (count < MATCHLOG_QUEUE && ring_pop(&queue, &record) == 0) {
+            matchlog_encode(batch + (size_t)count * MATCHLOG_RECORD_SIZE, &record);
+            count++;
+        }
+        if (count > 0) {
+            if (unsynced == 0) first_unsynced = now_ns();
+            write_batch(batch, count);
+            unsynced += count;
+        }
+
+        if (unsynced > 0 && (stop || unsynced >= MATCHLOG_SYNC_RECORDS ||
+                             now_ns() - first_unsynced >= MATCHLOG_SYNC_MS * 1000000LL)) {
+            sync_log();
+            unsynced = 0;
+        }
+        if (stop && ring_count(&queue) == 0) break;
+    }
+
+    if (log_fd != -1) close(log_fd);
+    log_fd = -1;
+    return NULL;
+}
+
+int matchlog_start(const char* path) {
+    if (started || strlen(path) >= sizeof(log_path)) return -1;
+    snprintf(log_path, sizeof(log_path), "%s", path);
+
+    if (open_log() == -1) return -1;
+    if (ring_init(&queue, sizeof(MatchRecord), MATCHLOG_QUEUE) != 0) goto fail;
+    if (sem_init(&wake, 0, 0) != 0) goto fail_ring;
+    atomic_init(&stopping, 0);
+    if (pthread_create(&writer_thread, NULL, writer_main, NULL) != 0) goto fail_sem;
+
+    started = 1;
+    return 0;
+
+fail_sem:
+    sem_destroy(&wake);
+fail_ring:
+    ring_free(&queue);
+fail:
+    close(log_fd);
+    log_fd = -1;
+    return -1;
+}
+
+int matchlog_submit(const MatchRecord* record) {
+    if (!started) return -1;
+    if (ring_push(&queue, record) != 0) {
+        atomic_fetch_add_explicit(&matchlog_stats.dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+    sem_post(&wake);
+    return 0;
+}
+
+void matchlog_stop(void) {
+    if (!started) return;
+    atomic_store(&stopping, 1);
+    sem_post(&wake);
+    pthread_join(writer_thread, NULL);
+    sem_destroy(&wake);
+    ring_free(&queue);
+    started = 0;
+}
+
+unsigned int matchlog_pending(void) {
+    return started ? ring_count(&queue) : 0;
+}
+
+// =========================================================
+// 조회
+// =========================================================
+
+static void print_record(const MatchRecord* r, FILE* out) {
+    char when[32];
+    time_t t = (time_t)r->started;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+
+    fprintf(out, "%s %7.1fs %4dHz winner=%-2d tick mean=%.2fms max=%.2fms over=%d damage=%d/%d/%d/%d",
+            when, r->duration_ms / 1000.0, r->tick_hz, r->winner,
+            r->tick_mean_ns / 1e6, r->tick_max_ns / 1e6, r->tick_overruns,
+            r->damage[DAMAGE_ARROW], r->damage[DAMAGE_SPECIAL],
+            r->damage[DAMAGE_ATTACK], r->damage[DAMAGE_REDZONE]);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        const MatchPlayer* mp = &r->player[i];
+        fprintf(out, " | p%d%s lives=%d score=%d hits=%d items=%d/%d/%d moves=%d drops=%d",
+                i, (mp->flags & MATCHLOG_CONNECTED) ? "" : "(left)", mp->lives, mp->score, mp->hits,
+                mp->items_used[0], mp->items_used[1], mp->items_used[2], mp->moves, mp->input_drops);
+    }
+    if (r->flags & MATCHLOG_LOCKSTEP) fprintf(out, " lockstep");
+    if (r->flags & MATCHLOG_DISCONNECT) fprintf(out, " disconnect");
+    if (r->flags & MATCHLOG_LAGCOMP) fprintf(out, " lagcomp");
+    fprintf(out, "\n");
+}
+
+long long matchlog_dump(const char* path, FILE* out) {
+    long long shown = 0, corrupt = 0;
+
+    for (int k = MATCHLOG_KEEP; k >= 0; k--) {
+        char name[PATH_MAX + 16];
+        rotated_path(name, sizeof(name), path, k);
+        int fd = open(name, O_RDONLY);
+        if (fd == -1) continue;
+
+        unsigned char buf[MATCHLOG_RECORD_SIZE];
+        while (read(fd, buf, sizeof(buf)) == (ssize_t)sizeof(buf)) {
+            MatchRecord record;
+            if (matchlog_decode(buf, &record) == -1) {
+                corrupt++;
+                continue;
+            }
+            print_record(&record, out);
+            shown++;
+        }
+        close(fd);
+    }
+    if (corrupt > 0) fprintf(out, "깨진 레코드 %lld개 건너뜀\n", corrupt);
+    return shown;
+}
@@ -11,6 +11,7 @@ int main(void) {
     int ch; 
 
     srand((unsigned int)time(NULL)); 
+    startScoreCompaction(); // 점수 파일 정리 (백그라운드)
     initNcurses(); // Ncurses 초기화
 
     int max_y, max_x;
@@ -0,0 +1,254 @@
+#include "metrics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <arpa/inet.h>
+#include "net.h"
+
+#define METRICS_IO_TIMEOUT_MS 1000  // 요청을 보내지 않거나 응답을 읽지 않는 스크레이퍼는 끊음
+
+Metrics metrics;
+int metrics_enabled = 0;
+
+// 틱 소요 시간 히스토그램 경계 (초)
+static const double tick_bounds[METRICS_TICK_BUCKETS] = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1
+};
+
+// 죽은 상대 감지 시간 히스토그램 경계 (초)
+static const double dead_bounds[METRICS_DEAD_BUCKETS] = {
+    0.25, 0.5, 1, 2, 3, 5, 10, 30
+};
+
+static const char* disconnect_names[DISCONNECT_REASONS] = {
+    "closed", "idle", "keepalive", "send"
+};
+
+static int listen_sock = -1;
+static long long budget_ns = 0;
+static void (*extra_metrics)(FILE* out) = NULL;
+
+void metrics_tick(long long elapsed_ns) {
+    if (!metrics_enabled) return;
+
+    atomic_fetch_add_explicit(&metrics.ticks, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metrics.tick_sum_ns, elapsed_ns, memory_order_relaxed);
+    if (budget_ns > 0 && elapsed_ns > budget_ns) {
+        atomic_fetch_add_explicit(&metrics.tick_overruns, 1, memory_order_relaxed);
+    }
+
+    double sec = elapsed_ns / 1e9;
+    for (int i = 0; i < METRICS_TICK_BUCKETS; i++) {
+        if (sec <= tick_bounds[i]) {
+            atomic_fetch_add_explicit(&metrics.tick_buckets[i], 1, memory_order_relaxed);
+            break;
+        }
+    }
+}
+
+static int type_index(int type) {
+    return (type >= 0 && type <= PACKET_TYPES) ? type : -1;
+}
+
+void metrics_packet_out(int type, size_t bytes) {
+    int i = type_index(type);
+    if (!metrics_enabled || i < 0) return;
+    atomic_fetch_add_explicit(&metrics.packets_out[i], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metrics.bytes_out[i], (long long)bytes, memory_order_relaxed);
+}
+
+void metrics_packet_in(int type, size_t bytes) {
+    int i = type_index(type);
+    if (!metrics_enabled || i < 0) return;
+    atomic_fetch_add_explicit(&metrics.packets_in[i], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metrics.bytes_in[i], (long long)bytes, memory_order_relaxed);
+}
+
+const char* disconnect_name(DisconnectReason reason) {
+    return (reason >= 0 && reason < DISCONNECT_REASONS) ? disconnect_names[reason] : "unknown";
+}
+
+void metrics_disconnect(DisconnectReason reason, long long silent_ns) {
+    if (!metrics_enabled || reason < 0 || reason >= DISCONNECT_REASONS) return;
+    atomic_fetch_add_explicit(&metrics.disconnects[reason], 1, memory_order_relaxed);
+    if (reason == DISCONNECT_CLOSED) return;
+
+    atomic_fetch_add_explicit(&metrics.dead_peers, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metrics.dead_peer_sum_ns, silent_ns, memory_order_relaxed);
+    double sec = silent_ns / 1e9;
+    for (int i = 0; i < METRICS_DEAD_BUCKETS; i++) {
+        if (sec <= dead_bounds[i]) {
+            atomic_fetch_add_explicit(&metrics.dead_peer_buckets[i], 1, memory_order_relaxed);
+            break;
+        }
+    }
+}
+
+#define LOAD(x) atomic_load_explicit(&(x), memory_order_relaxed)
+
+// 프로세스 상주 메모리 (바이트)
+static long long process_rss(void) {
+    long long pages = 0, resident = 0;
+    FILE* fp = fopen("/proc/self/statm", "r");
+    if (fp == NULL) return 0;
+    if (fscanf(fp, "%lld %lld", &pages, &resident) != 2) resident = 0;
+    fclose(fp);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+static void write_counter_by_type(FILE* out, const char* name, const char* help, atomic_llong* values) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+    for (int i = 0; i <= PACKET_TYPES; i++) {
+        long long v = LOAD(values[i]);
+        if (v > 0) fprintf(out, "%s{type=\"%s\"} %lld\n", name, packet_name(i), v);
+    }
+}
+
+static void write_metrics(FILE* out) {
+    fprintf(out, "# HELP spacewar_connected_clients Connected clients.\n");
+    fprintf(out, "# TYPE spacewar_connected_clients gauge\n");
+    fprintf(out, "spacewar_connected_clients %d\n", LOAD(metrics.connected));
+    fprintf(out, "# HELP spacewar_matches_active Matches in progress.\n");
+    fprintf(out, "# TYPE spacewar_matches_active gauge\n");
+    fprintf(out, "spacewar_matches_active %d\n", LOAD(metrics.matches_active));
+    fprintf(out, "# HELP spacewar_matches_total Matches started.\n");
+    fprintf(out, "# TYPE spacewar_matches_total counter\n");
+    fprintf(out, "spacewar_matches_total %lld\n", LOAD(metrics.matches_total));
+
+    fprintf(out, "# HELP spacewar_pool_used Active objects per pool.\n");
+    fprintf(out, "# TYPE spacewar_pool_used gauge\n");
+    fprintf(out, "spacewar_pool_used{pool=\"arrow\"} %d\n", LOAD(metrics.arrows_active));
+    fprintf(out, "spacewar_pool_used{pool=\"redzone\"} %d\n", LOAD(metrics.redzones_active));
+    fprintf(out, "# HELP spacewar_pool_capacity Pool sizes.\n");
+    fprintf(out, "# TYPE spacewar_pool_capacity gauge\n");
+    fprintf(out, "spacewar_pool_capacity{pool=\"arrow\"} %d\n", MAX_ARROWS);
+    fprintf(out, "spacewar_pool_capacity{pool=\"redzone\"} %d\n", MAX_REDZONES);
+
+    // Prometheus 히스토그램은 경계 이하 누적 개수
+    fprintf(out, "# HELP spacewar_tick_seconds Server tick duration excluding sleep.\n");
+    fprintf(out, "# TYPE spacewar_tick_seconds histogram\n");
+    long long cumulative = 0;
+    for (int i = 0; i < METRICS_TICK_BUCKETS; i++) {
+        cumulative += LOAD(metrics.tick_buckets[i]);
+        fprintf(out, "spacewar_tick_seconds_bucket{le=\"%g\"} %lld\n", tick_bounds[i], cumulative);
+    }
+    fprintf(out, "spacewar_tick_seconds_bucket{le=\"+Inf\"} %lld\n", LOAD(metrics.ticks));
+    fprintf(out, "spacewar_tick_seconds_sum %.9f\n", LOAD(metrics.tick_sum_ns) / 1e9);
+    fprintf(out, "spacewar_tick_seconds_count %lld\n", LOAD(metrics.ticks));
+    fprintf(out, "# HELP spacewar_tick_overruns_total Ticks over the tick budget.\n");
+    fprintf(out, "# TYPE spacewar_tick_overruns_total counter\n");
+    fprintf(out, "spacewar_tick_overruns_total %lld\n", LOAD(metrics.tick_overruns));
+
+    write_counter_by_type(out, "spacewar_packets_out_total", "Packets sent.", metrics.packets_out);
+    write_counter_by_type(out, "spacewar_bytes_out_total", "Bytes sent.", metrics.bytes_out);
+    write_counter_by_type(out, "spacewar_packets_in_total", "Packets received.", metrics.packets_in);
+    write_counter_by_type(out, "spacewar_bytes_in_total", "Bytes received.", metrics.bytes_in);
+    fprintf(out, "# HELP spacewar_send_errors_total Failed socket writes.\n");
+    fprintf(out, "# TYPE spacewar_send_errors_total counter\n");
+    fprintf(out, "spacewar_send_errors_total %lld\n", LOAD(metrics.send_errors));
+    fprintf(out, "# HELP spacewar_input_drops_total Inputs dropped because the queue was full.\n");
+    fprintf(out, "# TYPE spacewar_input_drops_total counter\n");
+    fprintf(out, "spacewar_input_drops_total %lld\n", LOAD(metrics.input_drops));
+
+    fprintf(out, "# HELP spacewar_disconnects_total Client connections closed, by cause.\n");
+    fprintf(out, "# TYPE spacewar_disconnects_total counter\n");
+    for (int i = 0; i < DISCONNECT_REASONS; i++) {
+        fprintf(out, "spacewar_disconnects_total{reason=\"%s\"} %lld\n",
+                disconnect_names[i], LOAD(metrics.disconnects[i]));
+    }
+    fprintf(out, "# HELP spacewar_dead_peer_detect_seconds Time from the last received byte to freeing a dead client's slot.\n");
+    fprintf(out, "# TYPE spacewar_dead_peer_detect_seconds histogram\n");
+    cumulative = 0;
+    for (int i = 0; i < METRICS_DEAD_BUCKETS; i++) {
+        cumulative += LOAD(metrics.dead_peer_buckets[i]);
+        fprintf(out, "spacewar_dead_peer_detect_seconds_bucket{le=\"%g\"} %lld\n", dead_bounds[i], cumulative);
+    }
+    fprintf(out, "spacewar_dead_peer_detect_seconds_bucket{le=\"+Inf\"} %lld\n", LOAD(metrics.dead_peers));
+    fprintf(out, "spacewar_dead_peer_detect_seconds_sum %.9f\n", LOAD(metrics.dead_peer_sum_ns) / 1e9);
+    fprintf(out, "spacewar_dead_peer_detect_seconds_count %lld\n", LOAD(metrics.dead_peers));
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    double cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+               + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+    fprintf(out, "# HELP process_cpu_seconds_total User and system CPU time.\n");
+    fprintf(out, "# TYPE process_cpu_seconds_total counter\n");
+    fprintf(out, "process_cpu_seconds_total %.3f\n", cpu);
+    fprintf(out, "# HELP process_resident_memory_bytes Resident memory size.\n");
+    fprintf(out, "# TYPE process_resident_memory_bytes gauge\n");
+    fprintf(out, "process_resident_memory_bytes %lld\n", process_rss());
+
+    if (extra_metrics != NULL) extra_metrics(out);
+}
+
+// 요청 내용은 보지 않고 항상 전체 지표로 응답
+// 메트릭 스레드는 하나이므로 멈춘 연결 하나가 다음 스크레이프를 막지 않게 읽기/쓰기 시간을 제한함
+static void serve(int sock) {
+    char request[1024];
+    net_io_timeout(sock, METRICS_IO_TIMEOUT_MS, METRICS_IO_TIMEOUT_MS);
+    if (read(sock, request, sizeof(request)) <= 0) return;
+
+    char* body = NULL;
+    size_t body_len = 0;
+    FILE* out = open_memstream(&body, &body_len);
+    if (out == NULL) return;
+    write_metrics(out);
+    fclose(out);
+
+    char header[128];
+    int header_len = snprintf(header, sizeof(header),
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: %zu\r\n\r\n", body_len);
+    net_write_full(sock, header, header_len);
+    net_write_full(sock, body, body_len);
+    free(body);
+}
+
+static void* metrics_thread(void* arg) {
+    (void)arg;
+    while (1) {
+        int sock = accept(listen_sock, NULL, NULL);
+        if (sock < 0) continue;
+        serve(sock);
+        close(sock);
+    }
+    return NULL;
+}
+
+int metrics_start(int port, long long tick_budget_ns, void (*extra)(FILE* out)) {
+    listen_sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_sock < 0) return -1;
+
+    int opt = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // 외부에 노출하지 않도록 루프백에만 바인드
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    if (bind(listen_sock, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listen_sock, 4) < 0) {
+        close(listen_sock);
+        listen_sock = -1;
+        return -1;
+    }
+
+    budget_ns = tick_budget_ns;
+    extra_metrics = extra;
+    metrics_enabled = 1;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, metrics_thread, NULL) != 0) {
+        metrics_enabled = 0;
+        return -1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
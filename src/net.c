@@ -0,0 +1,123 @@
+#include "net.h"
+#include "common.h"
+#include "timeutil.h"
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+int net_read_full(int fd, void* buf, size_t len) {
+    char* p = (char*)buf;
+    size_t done = 0;
+
+    while (done < len) {
+        ssize_t n = read(fd, p + done, len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+static const char* packet_names[PACKET_TYPES + 1] = {
+    "initial_state", "player_move", "player_status", "arrow_update",
+    "redzone_update", "item_use", "game_over", "state_update",
+    "lockstep_start", "heartbeat", "lockstep_input"
+};
+
+const char* packet_name(int type) {
+    return (type >= 0 && type <= PACKET_TYPES) ? packet_names[type] : "unknown";
+}
+
+int net_write_full(int fd, const void* buf, size_t len) {
+    const char* p = (const char*)buf;
+    size_t done = 0;
+
+    while (done < len) {
+        ssize_t n = send(fd, p + done, len - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+void net_keepalive(int fd, int timeout_ms) {
+    int on = 1;
+    int idle = timeout_ms / 2000 > 0 ? timeout_ms / 2000 : 1;   // 초 단위: 절반은 조용히 기다리고
+    int interval = 1;                                           // 나머지 동안 1초 간격으로 확인
+    int count = timeout_ms / 1000 - idle > 0 ? timeout_ms / 1000 - idle : 1;
+    unsigned int user_timeout = (unsigned int)timeout_ms;
+
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+    setsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &user_timeout, sizeof(user_timeout));
+}
+
+void net_io_timeout(int fd, int recv_ms, int send_ms) {
+    struct timeval rcv = { recv_ms / 1000, (recv_ms % 1000) * 1000 };
+    struct timeval snd = { send_ms / 1000, (send_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &rcv, sizeof(rcv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &snd, sizeof(snd));
+}
+
+void net_notify_ready(const char* error) {
+    const char* env = getenv(NET_READY_ENV);
+    if (env == NULL || env[0] == '\0') return;
+    unsetenv(NET_READY_ENV);    // 한 번만 (이후 exec 하는 자식에게 넘기지 않음)
+
+    char line[256];
+    int len = error == NULL ? snprintf(line, sizeof(line), "OK\n")
+                            : snprintf(line, sizeof(line), "ERR %s\n", error);
+    if (len >= (int)sizeof(line)) len = sizeof(line) - 1;
+
+    int fd = atoi(env);
+    const char* p = line;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        p += n;
+        len -= n;
+    }
+    close(fd);
+}
+
+int net_wait_ready(int fd, int timeout_ms, char* error, size_t size) {
+    char line[256];
+    size_t len = 0;
+    long long deadline = now_ns() + timeout_ms * 1000000LL;
+
+    // 줄 끝까지 읽거나, 쓰는 쪽이 모두 닫힐 때까지 (서버가 알리기 전에 죽은 경우)
+    while (len < sizeof(line) - 1 && (len == 0 || line[len - 1] != '\n')) {
+        long long left = (deadline - now_ns()) / 1000000;
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ready = left > 0 ? poll(&pfd, 1, (int)left) : 0;
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) {
+            snprintf(error, size, "%s", strerror(errno));
+            return -1;
+        }
+        if (ready == 0) {
+            snprintf(error, size, "no response in %d ms", timeout_ms);
+            return -1;
+        }
+        ssize_t n = read(fd, line + len, sizeof(line) - 1 - len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        len += (size_t)n;
+    }
+    line[len] = '\0';
+    line[strcspn(line, "\n")] = '\0';
+
+    if (strcmp(line, "OK") == 0) return 0;
+    if (strncmp(line, "ERR ", 4) == 0) snprintf(error, size, "%s", line + 4);
+    else snprintf(error, size, "exited before ready");
+    return -1;
+}
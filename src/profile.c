@@ -0,0 +1,108 @@
+#include "profile.h"
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+// 틱 스레드 하나에서만 기록함 (batch_sim 처럼 여러 스레드가 update_game 을 돌릴 때는 끄고 사용)
+int prof_enabled = 0;
+
+static ProfHistogram histograms[PROF_PHASES];
+static const char* phase_names[PROF_PHASES] = {
+    "lock_wait", "input", "players", "arrows", "redzones", "collisions",
+    "spawn", "events", "serialize", "send", "render", "tick"
+};
+
+static FILE* prof_out = NULL;
+static long long prof_interval_ns = 0;
+static long long prof_last_dump = 0;
+static long long prof_budget_ns = 0;
+static long long prof_overruns = 0;
+static volatile sig_atomic_t dump_requested = 0;
+
+static void on_sigusr1(int sig) {
+    (void)sig;
+    dump_requested = 1;
+}
+
+void prof_init(int interval_sec, long long budget_ns, FILE* out) {
+    memset(histograms, 0, sizeof(histograms));
+    prof_out = out;
+    prof_interval_ns = (long long)interval_sec * 1000000000LL;
+    prof_budget_ns = budget_ns;
+    prof_overruns = 0;
+    prof_last_dump = now_ns();
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigusr1;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+
+    prof_enabled = 1;
+}
+
+void prof_init_env(long long budget_ns, FILE* out) {
+    const char* env = getenv("SPACEWAR_PROFILE");
+    if (env == NULL) return;
+    prof_init(atoi(env), budget_ns, out);
+}
+
+void prof_end(ProfPhase phase, long long start) {
+    if (!prof_enabled) return;
+
+    long long elapsed = now_ns() - start;
+    ProfHistogram* h = &histograms[phase];
+    h->samples[h->next] = elapsed;
+    h->next = (h->next + 1) % PROF_WINDOW;
+    h->count++;
+    if (elapsed > h->max_ns) h->max_ns = elapsed;
+
+    if (phase == PROF_TICK && prof_budget_ns > 0 && elapsed > prof_budget_ns) {
+        prof_overruns++;
+    }
+}
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+void prof_dump(FILE* out) {
+    static long long sorted[PROF_WINDOW];
+
+    fprintf(out, "[profile] %-10s %8s %9s %9s %9s %9s\n",
+            "phase", "count", "p50(us)", "p99(us)", "max(us)", "all_max");
+    for (int p = 0; p < PROF_PHASES; p++) {
+        ProfHistogram* h = &histograms[p];
+        if (h->count == 0) continue;
+
+        int n = h->count < PROF_WINDOW ? (int)h->count : PROF_WINDOW;
+        memcpy(sorted, h->samples, n * sizeof(long long));
+        qsort(sorted, n, sizeof(long long), compare_ll);
+
+        fprintf(out, "[profile] %-10s %8lld %9.1f %9.1f %9.1f %9.1f\n",
+                phase_names[p], h->count,
+                sorted[n / 2] / 1000.0,
+                sorted[(n * 99) / 100] / 1000.0,
+                sorted[n - 1] / 1000.0,
+                h->max_ns / 1000.0);
+    }
+    if (prof_budget_ns > 0) {
+        fprintf(out, "[profile] budget=%lldus overruns=%lld/%lld\n",
+                prof_budget_ns / 1000, prof_overruns, histograms[PROF_TICK].count);
+    }
+    fflush(out);
+}
+
+void prof_poll(void) {
+    if (!prof_enabled || prof_out == NULL) return;
+
+    long long now = now_ns();
+    int due = prof_interval_ns > 0 && now - prof_last_dump >= prof_interval_ns;
+    if (!dump_requested && !due) return;
+
+    dump_requested = 0;
+    prof_last_dump = now;
+    prof_dump(prof_out);
+}
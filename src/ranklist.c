@@ -0,0 +1,141 @@
+#include "ranklist.h"
+#include "scoreboard.h"
+
+static RankNode* node_new(int level, const ScoreEntry* entry) {
+    RankNode* node = calloc(1, sizeof(RankNode) + level * sizeof(node->link[0]));
+    if (node == NULL) return NULL;
+    node->level = level;
+    if (entry != NULL) node->entry = *entry;
+    return node;
+}
+
+// 레벨이 하나 오를 확률 1/4
+static int random_level(RankList* list) {
+    int level = 1;
+    while (level < RANK_MAX_LEVEL && (rand_r(&list->seed) & 3) == 0) level++;
+    return level;
+}
+
+int rank_compare(const ScoreEntry* a, const ScoreEntry* b) {
+    int order = compareScores(a, b);
+    if (order != 0) return order;
+    order = strncmp(a->name, b->name, sizeof(a->name));
+    if (order != 0) return order;
+    return strncmp(a->mode, b->mode, sizeof(a->mode));
+}
+
+int rank_init(RankList* list, unsigned int seed) {
+    list->head = node_new(RANK_MAX_LEVEL, NULL);
+    list->level = 1;
+    list->length = 0;
+    list->seed = seed;
+    return list->head == NULL ? -1 : 0;
+}
+
+void rank_free(RankList* list) {
+    RankNode* node = list->head;
+    while (node != NULL) {
+        RankNode* next = node->link[0].next;
+        free(node);
+        node = next;
+    }
+    list->head = NULL;
+    list->length = 0;
+}
+
+// 각 레벨에서 entry 바로 앞 노드와 그 노드의 순위
+static void find_path(const RankList* list, const ScoreEntry* entry,
+                      RankNode** update, int* rank) {
+    RankNode* node = list->head;
+    int traversed = 0;
+    for (int i = list->level - 1; i >= 0; i--) {
+        while (node->link[i].next != NULL && rank_compare(&node->link[i].next->entry, entry) < 0) {
+            traversed += node->link[i].span;
+            node = node->link[i].next;
+        }
+        update[i] = node;
+        rank[i] = traversed;
+    }
+}
+
+int rank_insert(RankList* list, const ScoreEntry* entry) {
+    RankNode* update[RANK_MAX_LEVEL];
+    int rank[RANK_MAX_LEVEL];
+    find_path(list, entry, update, rank);
+
+    int level = random_level(list);
+    if (level > list->level) {
+        for (int i = list->level; i < level; i++) {
+            update[i] = list->head;
+            rank[i] = 0;
+            list->head->link[i].span = list->length;
+        }
+        list->level = level;
+    }
+
+    RankNode* node = node_new(level, entry);
+    if (node == NULL) return -1;
+
+    for (int i = 0; i < level; i++) {
+        node->link[i].next = update[i]->link[i].next;
+        update[i]->link[i].next = node;
+        // update[i] 에서 새 노드까지 (rank[0] - rank[i]) + 1 칸
+        node->link[i].span = update[i]->link[i].span - (rank[0] - rank[i]);
+        update[i]->link[i].span = (rank[0] - rank[i]) + 1;
+    }
+    for (int i = level; i < list->level; i++) update[i]->link[i].span++;
+
+    list->length++;
+    return 0;
+}
+
+int rank_remove(RankList* list, const ScoreEntry* entry) {
+    RankNode* update[RANK_MAX_LEVEL];
+    int rank[RANK_MAX_LEVEL];
+    find_path(list, entry, update, rank);
+
+    RankNode* node = update[0]->link[0].next;
+    if (node == NULL || rank_compare(&node->entry, entry) != 0) return -1;
+
+    for (int i = 0; i < list->level; i++) {
+        if (update[i]->link[i].next == node) {
+            update[i]->link[i].span += node->link[i].span - 1;
+            update[i]->link[i].next = node->link[i].next;
+        } else {
+            update[i]->link[i].span--;
+        }
+    }
+    while (list->level > 1 && list->head->link[list->level - 1].next == NULL) list->level--;
+
+    free(node);
+    list->length--;
+    return 0;
+}
+
+int rank_of(const RankList* list, const ScoreEntry* entry) {
+    const RankNode* node = list->head;
+    int traversed = 0;
+    for (int i = list->level - 1; i >= 0; i--) {
+        while (node->link[i].next != NULL && rank_compare(&node->link[i].next->entry, entry) <= 0) {
+            traversed += node->link[i].span;
+            node = node->link[i].next;
+        }
+        if (node != list->head && rank_compare(&node->entry, entry) == 0) return traversed;
+    }
+    return 0;
+}
+
+const RankNode* rank_at(const RankList* list, int rank) {
+    if (rank < 1 || rank > list->length) return NULL;
+
+    const RankNode* node = list->head;
+    int traversed = 0;
+    for (int i = list->level - 1; i >= 0; i--) {
+        while (node->link[i].next != NULL && traversed + node->link[i].span <= rank) {
+            traversed += node->link[i].span;
+            node = node->link[i].next;
+        }
+        if (traversed == rank) return node;
+    }
+    return NULL;
+}
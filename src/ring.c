@@ -0,0 +1,59 @@
+#include "ring.h"
+#include <stdlib.h>
+#include <string.h>
+
+int ring_init(Ring* ring, size_t elem_size, unsigned int capacity) {
+    // 용량을 2의 거듭제곱으로 올림 (인덱스를 & 연산으로 계산)
+    unsigned int cap = 1;
+    while (cap < capacity) cap <<= 1;
+
+    ring->buf = calloc(cap, elem_size);
+    if (!ring->buf) return -1;
+
+    ring->mask = cap - 1;
+    ring->elem_size = elem_size;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return 0;
+}
+
+void ring_free(Ring* ring) {
+    free(ring->buf);
+    ring->buf = NULL;
+}
+
+// 생산자 전용: 가득 차 있으면 -1 (기다리지 않음)
+int ring_push(Ring* ring, const void* elem) {
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (tail - head > ring->mask) return -1;
+
+    memcpy(ring->buf + (size_t)(tail & ring->mask) * ring->elem_size, elem, ring->elem_size);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+// 소비자 전용: 비어 있으면 -1
+int ring_pop(Ring* ring, void* elem) {
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head == tail) return -1;
+
+    memcpy(elem, ring->buf + (size_t)(head & ring->mask) * ring->elem_size, ring->elem_size);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return 0;
+}
+
+// 소비자 전용: 남은 항목 버리기
+void ring_clear(Ring* ring) {
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    atomic_store_explicit(&ring->head, tail, memory_order_release);
+}
+
+unsigned int ring_count(Ring* ring) {
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return tail - head;
+}
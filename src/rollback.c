@@ -0,0 +1,164 @@
+#include "rollback.h"
+#include "game_logic.h"
+#include "item.h"
+#include "timeutil.h"
+#include <string.h>
+
+void rollback_init(Rollback* rb, int my_id) {
+    memset(rb, 0, sizeof(Rollback));
+    rollback_reset(rb, my_id);
+}
+
+// 새 게임: 기록만 비우고 측정값은 유지
+void rollback_reset(Rollback* rb, int my_id) {
+    rb->my_id = my_id;
+    rb->last_ack = 0;
+    rb->lead = 1;
+    for (int i = 0; i < ROLLBACK_FRAMES; i++) {
+        rb->slot[i].frame = -1;
+    }
+}
+
+// 내 입력 적용 (서버의 client_handler 와 같은 규칙)
+void rollback_apply_input(GameState* state, int id, const FrameInput* input) {
+    Player* player = &state->player[id];
+
+    if (input->moved) {
+        player->x = input->x;
+        player->y = input->y;
+    }
+    switch (input->item) {
+        case 1: invincible_item(player, &state->config); break;
+        case 2: heal_item(player); break;
+        case 3: slow_item(player, &state->config); break;
+    }
+}
+
+// 서버 game_loop 한 틱과 동일한 진행
+void rollback_step(GameState* state) {
+    update_game(state, GAME_WIDTH, GAME_HEIGHT);
+    update_events(state, GAME_WIDTH, GAME_HEIGHT);
+}
+
+// 현재 프레임 상태(입력 적용 전)와 입력 기록
+void rollback_save(Rollback* rb, const GameState* state, const FrameInput* input) {
+    long long start = now_ns();
+
+    RollbackSlot* slot = &rb->slot[state->frame % ROLLBACK_FRAMES];
+    slot->frame = state->frame;
+    slot->time_ns = start;
+    slot->input = *input;
+    memcpy(&slot->state, state, sizeof(GameState));
+
+    rb->save_ns += now_ns() - start;
+    rb->saves++;
+}
+
+// 예측한 상태가 서버 상태와 같은지 (서버가 결정하는 부분만 비교)
+static int same_prediction(const GameState* predicted, const GameState* confirmed) {
+    Player players[MAX_PLAYERS];
+
+    // ack_frame/ack_trace 는 서버만 갱신하므로 비교에서 제외
+    memcpy(players, predicted->player, sizeof(players));
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        players[i].ack_frame = confirmed->player[i].ack_frame;
+        players[i].ack_trace = confirmed->player[i].ack_trace;
+    }
+
+    return predicted->special_wave == confirmed->special_wave &&
+           predicted->seed == confirmed->seed &&
+           memcmp(predicted->arrow, confirmed->arrow, sizeof(predicted->arrow)) == 0 &&
+           memcmp(predicted->redzone, confirmed->redzone, sizeof(predicted->redzone)) == 0 &&
+           memcmp(players, confirmed->player, sizeof(players)) == 0;
+}
+
+// 서버가 내 입력을 반영한 시점으로 왕복 시간과 예측 리드 갱신
+static void update_lead(Rollback* rb, int ack, const GameConfig* config) {
+    if (ack <= rb->last_ack) return;
+    rb->last_ack = ack;
+
+    RollbackSlot* slot = &rb->slot[ack % ROLLBACK_FRAMES];
+    if (slot->frame != ack) return;
+
+    long long rtt = now_ns() - slot->time_ns;
+    rb->rtt_ns = rb->rtt_ns ? (rb->rtt_ns * 7 + rtt) / 8 : rtt;
+
+    // 내 입력이 서버에 제때 도착하도록 왕복 시간만큼 앞서 예측
+    int lead = (int)(rb->rtt_ns / config_tick_ns(config)) + 1;
+    if (lead > ROLLBACK_FRAMES / 2) lead = ROLLBACK_FRAMES / 2;
+    rb->lead = lead;
+}
+
+// state(from 프레임)에서 end 프레임까지 기록된 입력으로 재시뮬레이션
+static void resimulate(Rollback* rb, GameState* state, int end, int ack) {
+    FrameInput none;
+    memset(&none, 0, sizeof(none));
+
+    for (int f = state->frame; f < end; f++) {
+        RollbackSlot* slot = &rb->slot[f % ROLLBACK_FRAMES];
+        const FrameInput* input = &none;
+
+        // 서버가 이미 반영한 입력은 다시 적용하지 않음
+        if (slot->frame == f && f > ack) {
+            input = &slot->input;
+        }
+        if (slot->frame != f) {
+            slot->frame = f;
+            slot->time_ns = now_ns();
+            slot->input = none;
+        }
+        memcpy(&slot->state, state, sizeof(GameState)); // 기록도 보정된 상태로 갱신
+
+        rollback_apply_input(state, rb->my_id, input);
+        rollback_step(state);
+    }
+}
+
+// 서버가 확정한 frame 상태를 받아 그 시점으로 되감고 현재 프레임까지 재시뮬레이션
+void rollback_correct(Rollback* rb, GameState* live, const GameState* confirmed) {
+    int from = confirmed->frame;
+    int to = live->frame;
+    int ack = confirmed->player[rb->my_id].ack_frame;
+
+    rb->corrections++;
+    update_lead(rb, ack, &confirmed->config);
+
+    int target = from + rb->lead;
+    int end = to;
+    int hard = from >= to || to - from >= ROLLBACK_FRAMES ||
+               rb->slot[from % ROLLBACK_FRAMES].frame != from;
+
+    // 리드에서 너무 벗어나면 (시계 차이, 렉) 타임라인을 목표 위치로 다시 맞춤
+    if (hard || to - target > ROLLBACK_SLACK || target - to > ROLLBACK_SLACK) {
+        end = target;
+    }
+
+    if (!hard && end == to &&
+        same_prediction(&rb->slot[from % ROLLBACK_FRAMES].state, confirmed)) {
+        rb->matches++;
+        return;
+    }
+
+    long long start = now_ns();
+    GameState state;
+    memcpy(&state, confirmed, sizeof(GameState));
+    resimulate(rb, &state, end, ack);
+    memcpy(live, &state, sizeof(GameState));
+
+    long long elapsed = now_ns() - start;
+    if (hard) rb->hard_resets++;
+    else rb->rollbacks++;
+    rb->resim_frames += end - from;
+    rb->resim_ns += elapsed;
+    if (elapsed > rb->resim_max_ns) rb->resim_max_ns = elapsed;
+}
+
+void rollback_report(const Rollback* rb, FILE* out) {
+    fprintf(out, "[rollback] saves=%lld avg_copy=%lldns corrections=%lld matched=%lld "
+                 "rollbacks=%lld hard_resets=%lld\n",
+            rb->saves, rb->saves ? rb->save_ns / rb->saves : 0,
+            rb->corrections, rb->matches, rb->rollbacks, rb->hard_resets);
+    fprintf(out, "[rollback] resim_frames=%lld avg_frame=%lldns max=%lldus rtt=%lldms lead=%d\n",
+            rb->resim_frames, rb->resim_frames ? rb->resim_ns / rb->resim_frames : 0,
+            rb->resim_max_ns / 1000, rb->rtt_ns / 1000000, rb->lead);
+}
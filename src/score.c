@@ -1,112 +1,192 @@
-#include <fcntl.h>  
-#include <unistd.h>     
-#include <sys/types.h>
-#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "common.h"
+#include "scoreboard.h"
+#include "leaderboard.h"
 
-#define SCORE_FILE_MODE 0644
 #define TOP_SCORES_DISPLAY 10
 
-// 파일에서 최고 점수 조회
-long highScore(void) {
-    int fd = open(SCORE_FILE, O_RDONLY);
-    if (fd == -1) return 0; 
+// 점수판 탭 (좌우 방향키로 전환)
+typedef enum {
+    TAB_LOCAL,          // 이 컴퓨터의 scores.dat
+    TAB_GLOBAL_SINGLE,  // 리더보드 데몬
+    TAB_GLOBAL_MULTI,
+    TAB_STATS,          // scores.dat.stats 의 모드별/마지막 플레이어 통계
+    TAB_COUNT
+} ScoreTab;
 
-    ScoreEntry entry;
-    long maxScore = 0;
-    ssize_t bytesRead;
+static const char* tab_titles[TAB_COUNT] = { "HALL OF FAME", "GLOBAL - SINGLE", "GLOBAL - MULTI", "STATISTICS" };
+static const char* tab_modes[TAB_COUNT] = { NULL, "SINGLE", "MULTI", NULL };
+static const char* stats_modes[] = { "SINGLE", "MULTI" };
 
-    // 최대값 갱신
-    while ((bytesRead = read(fd, &entry, sizeof(ScoreEntry))) == sizeof(ScoreEntry)) {
-        if (entry.score > maxScore) {
-            maxScore = entry.score;
-        }
-    }
+// 최고 점수 조회 (색인의 1위만 읽음)
+long highScore(void) {
+    return score_best(SCORE_FILE);
+}
 
-    close(fd);
-    return maxScore;
+static void makeEntry(ScoreEntry* entry, const char* name, int score, const char* mode) {
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    entry->score = score;
+    strncpy(entry->mode, mode, sizeof(entry->mode) - 1);
+    entry->timestamp = time(NULL);
 }
 
 // 점수판에 새 기록 추가
 void saveScore(const char* name, int score, const char* mode) {
+    ScoreEntry entry;
+    makeEntry(&entry, name, score, mode);
+    score_append(SCORE_FILE, &entry);
+}
 
-    int fd = open(SCORE_FILE, O_WRONLY | O_CREAT | O_APPEND, SCORE_FILE_MODE);
-
-    if (fd == -1) return;
+// 리더보드 데몬에 기록 제출, 그 모드에서 이 플레이어 최고 기록의 순위를 받음
+// 데몬이 없거나 응답하지 않으면 0
+int submitScore(const char* name, int score, const char* mode, int* rank, int* total) {
+    int fd = lb_connect(lb_address());
+    if (fd == -1) return 0;
 
     ScoreEntry entry;
-    strncpy(entry.name, name, sizeof(entry.name) - 1);
-    entry.name[sizeof(entry.name) - 1] = '\0';
-    entry.score = score;
-    strncpy(entry.mode, mode, sizeof(entry.mode) - 1);
-    entry.mode[sizeof(entry.mode) - 1] = '\0';
-    entry.timestamp = time(NULL);
-
-    write(fd, &entry, sizeof(ScoreEntry)); // 파일에 데이터 기록
+    LbResult result;
+    makeEntry(&entry, name, score, mode);
+    int ok = lb_submit(fd, &entry, &result) == 0 && result.status == LB_OK && result.count == 1;
     close(fd);
-}
 
-// 파일의 모든 점수 데이터 로드 및 메모리 할당
-int loadScores(ScoreEntry** entries) {
-    int fd = open(SCORE_FILE, O_RDONLY);
-    if (fd == -1) {
-        *entries = NULL;
-        return 0;
+    if (ok) {
+        *rank = result.first_rank;
+        *total = result.total;
     }
+    return ok;
+}
 
-    // 파일 끝으로 이동하여 크기 계산
-    off_t fileSize = lseek(fd, 0, SEEK_END);
-    lseek(fd, 0, SEEK_SET); // 다시 처음으로
+// 점수 파일이 충분히 커졌으면 백그라운드에서 압축
+// 손자 프로세스에서 돌리므로 메뉴는 기다리지 않고, 좀비도 남지 않음
+void startScoreCompaction(void) {
+    if (!score_compact_needed(SCORE_FILE)) return;
 
-    int count = fileSize / sizeof(ScoreEntry);
-    if (count == 0) {
-        close(fd);
-        *entries = NULL;
-        return 0;
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (fork() == 0) {
+            nice(10);
+            score_compact(SCORE_FILE, SCORE_KEEP_PER_KEY);
+        }
+        _exit(0);
     }
+    if (pid > 0) waitpid(pid, NULL, 0);
+}
 
-    // 데이터 개수만큼 동적 할당
-    *entries = (ScoreEntry*)malloc(sizeof(ScoreEntry) * count);
-    if (*entries == NULL) {
-        close(fd);
-        return 0;
+// 점수판 헤더 그리기
+void drawScoreboard(WINDOW* win, int width, const char* title) {
+    // 타이틀
+    wattron(win, COLOR_PAIR(COLOR_PAIR_TITLE) | A_BOLD);
+    mvwprintw(win, 1, (width - strlen(title))/2, "%s", title);
+    wattroff(win, COLOR_PAIR(COLOR_PAIR_TITLE) | A_BOLD);
+
+    // 헤더
+    wattron(win, COLOR_PAIR(COLOR_PAIR_DECO_BLUE));
+    mvwhline(win, 2, 1, ACS_HLINE, width - 2);
+    mvwprintw(win, 3, 2, "RANK  NAME         SCORE    MODE");
+    mvwhline(win, 4, 1, ACS_HLINE, width - 2);
+    wattroff(win, COLOR_PAIR(COLOR_PAIR_DECO_BLUE));
+}
+
+// 탭 하나의 순위 읽기 (전역 탭은 데몬이 없으면 -1)
+static int loadTab(ScoreTab tab, int lb_fd, ScoreEntry* entries, int* first_rank) {
+    *first_rank = 1;
+    if (tab == TAB_LOCAL) {
+        // 색인에서 정렬된 상위 기록만 읽음
+        return score_top(SCORE_FILE, entries, TOP_SCORES_DISPLAY);
     }
 
-    // 한 번에 다 읽지 않고 반복문으로 읽기
-    int i = 0;
-    while (i < count && read(fd, &(*entries)[i], sizeof(ScoreEntry)) == sizeof(ScoreEntry)) {
-        i++;
+    LbResult result;
+    if (lb_fd == -1 || lb_top(lb_fd, tab_modes[tab], TOP_SCORES_DISPLAY, &result) != 0 ||
+        result.status != LB_OK) return -1;
+    memcpy(entries, result.rows, sizeof(ScoreEntry) * result.count);
+    if (result.count > 0) *first_rank = result.first_rank;
+    return result.count;
+}
+
+// 순위 탭 하나 그리기
+static void drawRanking(WINDOW* win, int width, ScoreTab tab, int lb_fd) {
+    drawScoreboard(win, width, tab_titles[tab]);
+
+    ScoreEntry entries[TOP_SCORES_DISPLAY];
+    int first_rank;
+    int count = loadTab(tab, lb_fd, entries, &first_rank);
+
+    // 점수판 순위 출력
+    int listStart_y = 5;
+    for(int i = 0; i < count; i++) {
+        int rank = first_rank + i;
+
+        // 1~3등은 색상을 다르게
+        int color = (rank <= 3) ? COLOR_PAIR_SELECTED : COLOR_PAIR_NORMAL;
+        if(rank <= 3) wattron(win, COLOR_PAIR(color) | A_BOLD);
+
+        mvwprintw(win, listStart_y + i, 2,
+            " #%-2d  %-10s   %6d   %-6s",
+            rank,
+            entries[i].name,
+            entries[i].score,
+            entries[i].mode);
+
+        if(rank <= 3) wattroff(win, COLOR_PAIR(color) | A_BOLD);
     }
 
-    close(fd);
-    return i;
+    // 데이터가 없을 때 안내
+    if(count == 0) {
+        mvwprintw(win, 10, (width - 20)/2, "NO RECORDS FOUND.");
+    } else if(count < 0) {
+        mvwprintw(win, 10, (width - 20)/2, "LEADERBOARD OFFLINE");
+    }
 }
 
-// 점수 내림차순 정렬
-int compareScores(const void* a, const void* b) {
-    ScoreEntry* entryA = (ScoreEntry*)a;
-    ScoreEntry* entryB = (ScoreEntry*)b;
-    
-    if (entryB->score != entryA->score)
-        return entryB->score - entryA->score;  // 높은 점수 먼저
-    
-    return entryB->timestamp - entryA->timestamp;  // 같은 점수면 최신 먼저
+// 통계 한 줄 (기록이 없으면 "-")
+static void drawStatsRow(WINDOW* win, int y, const char* label, const char* name, const char* mode) {
+    ScoreStats stats;
+    if (score_stats(SCORE_FILE, name, mode, &stats) == -1) {
+        mvwprintw(win, y, 2, " %-8s %5s", label, "-");
+        return;
+    }
+    mvwprintw(win, y, 2, " %-8s %5lld %6d %6.0f %6d %6d %6d",
+        label, stats.games, stats.best, stats.mean, stats.p50, stats.p90, stats.p99);
 }
 
-// 점수판 헤더 그리기
-void drawScoreboard(WINDOW* win, int width) {
-    // 타이틀
-    const char* title = "HALL OF FAME";
+// 통계 탭: 모드 전체, 그리고 마지막으로 플레이한 사람의 모드별 통계
+// 모두 통계 파일의 해시 조회라서 기록 수와 무관하게 바로 그려짐
+static void drawStats(WINDOW* win, int width) {
+    const char* title = tab_titles[TAB_STATS];
     wattron(win, COLOR_PAIR(COLOR_PAIR_TITLE) | A_BOLD);
     mvwprintw(win, 1, (width - strlen(title))/2, "%s", title);
     wattroff(win, COLOR_PAIR(COLOR_PAIR_TITLE) | A_BOLD);
 
-    // 헤더
     wattron(win, COLOR_PAIR(COLOR_PAIR_DECO_BLUE));
     mvwhline(win, 2, 1, ACS_HLINE, width - 2);
-    mvwprintw(win, 3, 2, "RANK  NAME         SCORE    MODE");
+    mvwprintw(win, 3, 2, "          GAMES   BEST   MEAN    P50    P90    P99");
     mvwhline(win, 4, 1, ACS_HLINE, width - 2);
     wattroff(win, COLOR_PAIR(COLOR_PAIR_DECO_BLUE));
+
+    int y = 5;
+    for (size_t i = 0; i < sizeof(stats_modes) / sizeof(stats_modes[0]); i++) {
+        drawStatsRow(win, y++, stats_modes[i], NULL, stats_modes[i]);
+    }
+
+    ScoreEntry last;
+    if (score_last(SCORE_FILE, &last) == -1) return;
+
+    y++;
+    wattron(win, COLOR_PAIR(COLOR_PAIR_SELECTED) | A_BOLD);
+    mvwprintw(win, y++, 2, " %s", last.name);
+    wattroff(win, COLOR_PAIR(COLOR_PAIR_SELECTED) | A_BOLD);
+    for (size_t i = 0; i < sizeof(stats_modes) / sizeof(stats_modes[0]); i++) {
+        drawStatsRow(win, y++, stats_modes[i], last.name, stats_modes[i]);
+    }
+
+    // 마지막 판이 그 모드의 모든 판 중 몇 %를 이겼는지
+    double beaten = score_stats_beaten(SCORE_FILE, last.mode, last.score);
+    if (beaten >= 0) {
+        y++;
+        mvwprintw(win, y, 2, " LAST %d BEATS %.0f%% OF %s RUNS", last.score, beaten * 100, last.mode);
+    }
 }
 
 // 점수판 UI 전체 출력
@@ -123,55 +203,35 @@ void handleScoreboard(void) {
     // 배경 그림자 및 메인 윈도우 생성
     draw_box_with_shadow(start_y, start_x, win_height, win_width);
     WINDOW* win = newwin(win_height, win_width, start_y, start_x);
-    
-    wbkgd(win, COLOR_PAIR(COLOR_PAIR_NORMAL));
-    wattron(win, COLOR_PAIR(COLOR_PAIR_BORDER) | A_BOLD);
-    box(win, 0, 0);
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_BORDER) | A_BOLD);
-
-    drawScoreboard(win, win_width);
-
-    // 점수 로드 및 정렬
-    ScoreEntry* entries = NULL;
-    int count = loadScores(&entries);
-    
-    if (count > 0 && entries != NULL) {
-        qsort(entries, count, sizeof(ScoreEntry), compareScores);
-    }
+    keypad(win, TRUE);
 
-    // 점수판 순위 출력
-    int listStart_y = 5;
-    for(int i = 0; i < TOP_SCORES_DISPLAY; i++) {
-        if(i >= count) break;
-        
-        // 1~3등은 색상을 다르게
-        int color = (i < 3) ? COLOR_PAIR_SELECTED : COLOR_PAIR_NORMAL;
-        if(i < 3) wattron(win, COLOR_PAIR(color) | A_BOLD);
-        
-        mvwprintw(win, listStart_y + i, 2, 
-            " #%-2d  %-10s   %6d   %-6s", 
-            i+1, 
-            entries[i].name, 
-            entries[i].score, 
-            entries[i].mode);
-            
-        if(i < 3) wattroff(win, COLOR_PAIR(color) | A_BOLD);
-    }
+    int lb_fd = lb_connect(lb_address());   // 데몬이 없으면 전역 탭은 OFFLINE
+    ScoreTab tab = TAB_LOCAL;
+    int ch = 0;
 
-    // 데이터가 없을 때 안내
-    if(count == 0) {
-        mvwprintw(win, 10, (win_width - 20)/2, "NO RECORDS FOUND.");
-    }
+    do {
+        if (ch == KEY_RIGHT) tab = (tab + 1) % TAB_COUNT;
+        else if (ch == KEY_LEFT) tab = (tab + TAB_COUNT - 1) % TAB_COUNT;
+
+        werase(win);
+        wbkgd(win, COLOR_PAIR(COLOR_PAIR_NORMAL));
+        wattron(win, COLOR_PAIR(COLOR_PAIR_BORDER) | A_BOLD);
+        box(win, 0, 0);
+        wattroff(win, COLOR_PAIR(COLOR_PAIR_BORDER) | A_BOLD);
 
-    if(entries) free(entries);
+        if (tab == TAB_STATS) drawStats(win, win_width);
+        else drawRanking(win, win_width, tab, lb_fd);
 
-    // 하단 종료 안내
-    const char* hint = "PRESS ANY KEY TO CLOSE";
-    wattron(win, COLOR_PAIR(COLOR_PAIR_STATUS) | A_BLINK);
-    mvwprintw(win, win_height-2, (win_width - strlen(hint))/2, "%s", hint);
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_STATUS) | A_BLINK);
+        // 하단 안내
+        const char* hint = "<- -> TABS   OTHER KEY TO CLOSE";
+        wattron(win, COLOR_PAIR(COLOR_PAIR_STATUS) | A_BLINK);
+        mvwprintw(win, win_height-2, (win_width - strlen(hint))/2, "%s", hint);
+        wattroff(win, COLOR_PAIR(COLOR_PAIR_STATUS) | A_BLINK);
 
-    wrefresh(win);
-    wgetch(win); // 키 입력 대기
+        wrefresh(win);
+        ch = wgetch(win); // 키 입력 대기
+    } while (ch == KEY_LEFT || ch == KEY_RIGHT);
+
+    if (lb_fd != -1) close(lb_fd);
     delwin(win);
-}
\ No newline at end of file
+}
@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "scoreboard.h"
+#include "timeutil.h"
+
+// 점수판 벤치마크
+// 기록 수백만 개짜리 v1 점수 파일을 만들고, 예전 방식 (전체 스캔 + qsort) 과
+// v2 변환, mmap 전체 읽기, 색인 방식의 최고 점수/상위 10개 조회, 통계 조회, 기록 추가 시간을 비교한다.
+// 통계 스케치의 분위수는 전체 정렬로 구한 정확한 값과 비교한다.
+// 마지막으로 여러 프로세스가 동시에 기록을 붙이는 동안 압축을 반복해 잃어버린 기록이 없는지 확인한다.
+
+#define DEFAULT_ENTRIES 2000000
+#define DEFAULT_REPEAT  1000
+#define DEFAULT_WRITERS 4
+#define TOP_N 10
+#define WRITE_CHUNK 4096
+
+static const char* modes[] = { "SINGLE", "MULTI" };
+
+static void make_entry(ScoreEntry* entry, unsigned int* seed, time_t base, int i) {
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->name, sizeof(entry->name), "p%04d", rand_r(seed) % 5000);
+    snprintf(entry->mode, sizeof(entry->mode), "%s", modes[rand_r(seed) % 2]);
+    entry->score = rand_r(seed) % 100000;
+    entry->timestamp = base + i;
+}
+
+// v1 형식 (구조체를 그대로 이어 붙임)
+static int generate(const char* path, int count, unsigned int seed) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return -1;
+
+    static ScoreEntry chunk[WRITE_CHUNK];
+    time_t base = time(NULL) - count;
+    for (int i = 0; i < count; ) {
+        int n = 0;
+        for (; n < WRITE_CHUNK && i < count; n++, i++) make_entry(&chunk[n], &seed, base, i);
+        if (write(fd, chunk, sizeof(ScoreEntry) * n) != (ssize_t)(sizeof(ScoreEntry) * n)) {
+            close(fd);
+            return -1;
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+// 예전 highScore: 기록마다 read() 한 번
+static long legacy_high_score(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return 0;
+
+    ScoreEntry entry;
+    long maxScore = 0;
+    while (read(fd, &entry, sizeof(ScoreEntry)) == sizeof(ScoreEntry)) {
+        if (entry.score > maxScore) maxScore = entry.score;
+    }
+    close(fd);
+    return maxScore;
+}
+
+// 예전 handleScoreboard: 전체 로드 (기록마다 read) 후 qsort
+static int legacy_top(const char* path, ScoreEntry* out, int max) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return 0;
+
+    off_t size = lseek(fd, 0, SEEK_END);
+    lseek(fd, 0, SEEK_SET);
+    int count = size / sizeof(ScoreEntry);
+    ScoreEntry* entries = malloc(sizeof(ScoreEntry) * (count > 0 ? count : 1));
+    if (entries == NULL) {
+        close(fd);
+        return 0;
+    }
+
+    int i = 0;
+    while (i < count && read(fd, &entries[i], sizeof(ScoreEntry)) == sizeof(ScoreEntry)) i++;
+    close(fd);
+
+    qsort(entries, i, sizeof(ScoreEntry), compareScores);
+    int n = i < max ? i : max;
+    memcpy(out, entries, sizeof(ScoreEntry) * n);
+    free(entries);
+    return n;
+}
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// mode 의 모든 점수를 정렬해 구한 분위수와 스케치 값의 최대 상대 오차
+static double quantile_error(const char* path, const char* mode, const ScoreStats* stats) {
+    ScoreMap map;
+    if (score_map_open(path, &map) == -1) return -1;
+    int* scores = malloc(sizeof(int) * (map.count > 0 ? map.count : 1));
+    long long n = 0;
+    ScoreEntry entry;
+    for (long long i = 0; i < map.count && scores != NULL; i++) {
+        if (score_map_get(&map, i, &entry) == 0 && strcmp(entry.mode, mode) == 0) scores[n++] = entry.score;
+    }
+    score_map_close(&map);
+    if (scores == NULL || n == 0) {
+        free(scores);
+        return -1;
+    }
+    qsort(scores, n, sizeof(int), compare_int);
+
+    const double qs[] = { 0.50, 0.90, 0.99 };
+    const int approx[] = { stats->p50, stats->p90, stats->p99 };
+    double worst = 0;
+    for (int i = 0; i < 3; i++) {
+        int exact = scores[(long long)(qs[i] * (n - 1))];
+        double error = exact > 0 ? (double)abs(approx[i] - exact) / exact : 0;
+        if (error > worst) worst = error;
+    }
+    free(scores);
+    return worst;
+}
+
+static long long file_size(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long long)st.st_size : 0;
+}
+
+// 동시 쓰기 프로세스: 자기 이름으로 count 개 추가
+static void run_writer(const char* path, int id, int count) {
+    ScoreEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    snprintf(entry.name, sizeof(entry.name), "w%d", id);
+    snprintf(entry.mode, sizeof(entry.mode), "BENCH");
+    for (int i = 0; i < count; i++) {
+        entry.score = i;
+        entry.timestamp = i;
+        if (score_append(path, &entry) != 0) _exit(1);
+    }
+    _exit(0);
+}
+
+// 쓰는 프로세스가 모두 끝날 때까지 압축을 반복하고, 각자 쓴 기록이 모두 남았는지 확인
+static int concurrent_check(const char* path, int writers, int count) {
+    pid_t pids[64];
+    if (writers > 64) writers = 64;
+    for (int w = 0; w < writers; w++) {
+        pids[w] = fork();
+        if (pids[w] == 0) run_writer(path, w, count);
+    }
+
+    int running = writers, failed = 0, compactions = 0;
+    while (running > 0) {
+        if (score_compact(path, count) < 0) failed = 1;   // 쓰는 기록은 모두 남도록 keep = count
+        compactions++;
+        int status;
+        for (int w = 0; w < writers; w++) {
+            if (pids[w] > 0 && waitpid(pids[w], &status, WNOHANG) == pids[w]) {
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failed = 1;
+                pids[w] = 0;
+                running--;
+            }
+        }
+    }
+
+    ScoreMap map;
+    ScoreEntry entry;
+    long long corrupt = 0;
+    int* seen = calloc(writers, sizeof(int));
+    score_map_open(path, &map);
+    for (long long i = 0; i < map.count; i++) {
+        if (score_map_get(&map, i, &entry) == -1) {
+            corrupt++;
+            continue;
+        }
+        int id;
+        if (strcmp(entry.mode, "BENCH") == 0 && sscanf(entry.name, "w%d", &id) == 1 &&
+            id >= 0 && id < writers) seen[id]++;
+    }
+    score_map_close(&map);
+
+    int lost = 0;
+    for (int w = 0; w < writers; w++) if (seen[w] != count) lost++;
+    printf("  %-28s %d writers x %d, %d compactions, corrupt %lld, writers with missing/extra %d\n",
+           "concurrent append+compact", writers, count, compactions, corrupt, lost);
+    free(seen);
+    return failed || corrupt > 0 || lost > 0 ? -1 : 0;
+}
+
+static void report(const char* name, long long total_ns, int repeat) {
+    double per = (double)total_ns / repeat;
+    if (per >= 1e6) printf("  %-28s %10.2f ms\n", name, per / 1e6);
+    else printf("  %-28s %10.2f us\n", name, per / 1e3);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "사용법: %s [-n 기록수] [-r 반복] [-d 디렉토리] [-s 시드] [-w 동시쓰기] [-k]\n"
+        "  -k : 예전 방식 (전체 스캔) 측정 생략\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    int count = DEFAULT_ENTRIES;
+    int repeat = DEFAULT_REPEAT;
+    const char* dir = "/tmp";
+    unsigned int seed = 1;
+    int writers = DEFAULT_WRITERS;
+    int skip_legacy = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:d:s:w:kh")) != -1) {
+        switch (opt) {
+            case 'n': count = atoi(optarg); break;
+            case 'r': repeat = atoi(optarg); break;
+            case 'd': dir = optarg; break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'w': writers = atoi(optarg); break;
+            case 'k': skip_legacy = 1; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (count <= 0 || repeat <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    char path[512], idx[520], backup[520], lock[520], stats_file[520];
+    snprintf(path, sizeof(path), "%s/score_bench.%d.dat", dir, (int)getpid());
+    snprintf(idx, sizeof(idx), "%s%s", path, SCORE_INDEX_SUFFIX);
+    snprintf(backup, sizeof(backup), "%s%s", path, SCORE_LEGACY_SUFFIX);
+    snprintf(lock, sizeof(lock), "%s%s", path, SCORE_LOCK_SUFFIX);
+    snprintf(stats_file, sizeof(stats_file), "%s%s", path, SCORE_STATS_SUFFIX);
+
+    long long t0 = now_ns();
+    if (generate(path, count, seed) != 0) {
+        perror("점수 파일 생성 실패");
+        return 1;
+    }
+    printf("%d entries (%.1f MB), %d repeats\n\n", count,
+           (double)count * sizeof(ScoreEntry) / (1 << 20), repeat);
+    report("generate", now_ns() - t0, 1);
+
+    ScoreEntry legacy[TOP_N], indexed[TOP_N];
+    long legacy_best = -1;
+    if (!skip_legacy) {
+        t0 = now_ns();
+        legacy_best = legacy_high_score(path);
+        report("legacy highScore", now_ns() - t0, 1);
+        t0 = now_ns();
+        legacy_top(path, legacy, TOP_N);
+        report("legacy top 10 (load+qsort)", now_ns() - t0, 1);
+    }
+
+    t0 = now_ns();
+    if (score_convert(path) != 0) {
+        perror("v2 변환 실패");
+        return 1;
+    }
+    report("convert v1 -> v2 (once)", now_ns() - t0, 1);
+
+    // 매핑만 하고 레코드는 읽을 때 해석
+    ScoreMap map;
+    t0 = now_ns();
+    for (int i = 0; i < repeat; i++) {
+        score_map_open(path, &map);
+        score_map_close(&map);
+    }
+    report("map open", now_ns() - t0, repeat);
+
+    ScoreEntry entry;
+    long long valid = 0, sum = 0;
+    t0 = now_ns();
+    score_map_open(path, &map);
+    for (long long i = 0; i < map.count; i++) {
+        if (score_map_get(&map, i, &entry) == 0) {
+            valid++;
+            sum += entry.score;
+        }
+    }
+    score_map_close(&map);
+    report("scan all (mmap+crc)", now_ns() - t0, 1);
+    if (valid != count) printf("  %-28s %10lld / %d\n", "valid records", valid, count);
+
+    // 색인이 없는 기존 파일을 처음 열 때 한 번만 전체 스캔
+    ScoreIndex index;
+    t0 = now_ns();
+    score_index_load(path, &index);
+    report("index build (once)", now_ns() - t0, 1);
+
+    long best = 0;
+    t0 = now_ns();
+    for (int i = 0; i < repeat; i++) best = score_best(path);
+    report("indexed highScore", now_ns() - t0, repeat);
+
+    int n = 0;
+    t0 = now_ns();
+    for (int i = 0; i < repeat; i++) n = score_top(path, indexed, TOP_N);
+    report("indexed top 10", now_ns() - t0, repeat);
+
+    if (!skip_legacy) {
+        int same = (best == legacy_best);
+        for (int i = 0; i < n && same; i++) same = compareScores(&legacy[i], &indexed[i]) == 0;
+        printf("  %-28s %10s\n", "matches legacy", same ? "yes" : "NO");
+    }
+
+    // 통계도 처음 한 번만 전체를 반영하고, 이후 조회는 해시 한 번
+    ScoreStats stats;
+    t0 = now_ns();
+    score_stats(path, NULL, "SINGLE", &stats);
+    report("stats build (once)", now_ns() - t0, 1);
+
+    t0 = now_ns();
+    for (int i = 0; i < repeat; i++) score_stats(path, NULL, "SINGLE", &stats);
+    report("stats mode query", now_ns() - t0, repeat);
+
+    ScoreStats player;
+    t0 = now_ns();
+    for (int i = 0; i < repeat; i++) score_stats(path, "p0042", "SINGLE", &player);
+    report("stats player query", now_ns() - t0, repeat);
+
+    double beaten = 0;
+    t0 = now_ns();
+    for (int i = 0; i < repeat; i++) beaten = score_stats_beaten(path, "SINGLE", 50000);
+    report("stats beaten query", now_ns() - t0, repeat);
+    printf("  %-28s %lld games, p50 %d p90 %d p99 %d, 50000 beats %.1f%%\n", "",
+           stats.games, stats.p50, stats.p90, stats.p99, beaten * 100);
+    printf("  %-28s %9.2f %%\n", "sketch max quantile error", quantile_error(path, "SINGLE", &stats) * 100);
+
+    time_t base = time(NULL);
+    t0 = now_ns();
+    for (int i = 0; i < repeat; i++) {
+        make_entry(&entry, &seed, base, i);
+        score_append(path, &entry);
+    }
+    report("saveScore (append+idx+stats)", now_ns() - t0, repeat);
+
+    long long before = file_size(path);
+    t0 = now_ns();
+    long long removed = score_compact(path, SCORE_KEEP_PER_KEY);
+    report("compact (best 10/player)", now_ns() - t0, 1);
+    printf("  %-28s %10lld removed, %.1f MB -> %.1f MB\n", "", removed,
+           before / 1048576.0, file_size(path) / 1048576.0);
+
+    t0 = now_ns();
+    for (int i = 0; i < repeat; i++) best = score_best(path);
+    report("indexed highScore (compact)", now_ns() - t0, repeat);
+
+    // 압축으로 지운 기록도 통계에는 남아 있어야 함
+    ScoreStats total[2];
+    long long games = 0;
+    for (int m = 0; m < 2; m++) {
+        if (score_stats(path, NULL, modes[m], &total[m]) == 0) games += total[m].games;
+    }
+    printf("  %-28s %10lld / %d\n", "stats games after compact", games, count + repeat);
+
+    int result = 0;
+    if (writers > 0) result = concurrent_check(path, writers, repeat);
+
+    unlink(path);
+    unlink(idx);
+    unlink(backup);
+    unlink(lock);
+    unlink(stats_file);
+    (void)sum;
+    return result == 0 ? 0 : 1;
+}
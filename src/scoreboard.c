@@ -0,0 +1,1006 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include "scoreboard.h"
+#include "codec.h"
+
+#define SCORE_FILE_MODE 0644
+#define WRITE_CHUNK 4096        // 새 파일을 쓸 때 한 번에 쓰는 레코드 수
+#define KEEP_TABLE_INIT 1024    // 압축용 플레이어/모드 해시 테이블 초기 크기
+
+static const char score_magic[4] = { 'S', 'W', 'S', 'C' };
+static const char index_magic[4] = { 'S', 'W', 'I', 'X' };
+
+// =========================================================
+// 헤더 / 레코드
+// =========================================================
+
+static void encode_header(unsigned char* p, uint32_t compacted) {
+    memset(p, 0, SCORE_HEADER_SIZE);
+    memcpy(p, score_magic, sizeof(score_magic));
+    put_le32(p + 4, SCORE_VERSION);
+    put_le32(p + 8, SCORE_HEADER_SIZE);
+    put_le32(p + 12, SCORE_RECORD_SIZE);
+    put_le64(p + 16, (uint64_t)time(NULL));
+    put_le32(p + 24, compacted);
+    put_le32(p + 28, crc32(p, 28));
+}
+
+// 1: v2 헤더, 0: 매직이 없음 (v1 또는 빈 파일), -1: 매직은 있는데 깨졌거나 모르는 버전
+static int check_header(const unsigned char* p, ssize_t len) {
+    if (len < (ssize_t)sizeof(score_magic) || memcmp(p, score_magic, sizeof(score_magic)) != 0) return 0;
+    if (len < SCORE_HEADER_SIZE || get_le32(p + 28) != crc32(p, 28)) return -1;
+    if (get_le32(p + 4) != SCORE_VERSION ||
+        get_le32(p + 8) != SCORE_HEADER_SIZE ||
+        get_le32(p + 12) != SCORE_RECORD_SIZE) return -1;
+    return 1;
+}
+
+void score_encode_record(unsigned char* p, const ScoreEntry* entry) {
+    memset(p, 0, SCORE_RECORD_SIZE);
+    put_le64(p, (uint64_t)(int64_t)entry->timestamp);
+    put_le32(p + 8, (uint32_t)entry->score);
+    memcpy(p + 12, entry->name, strnlen(entry->name, 19));
+    memcpy(p + 32, entry->mode, strnlen(entry->mode, 9));
+    put_le32(p + 44, crc32(p, 44));
+}
+
+static int check_record(const unsigned char* p) {
+    return get_le32(p + 44) == crc32(p, 44) ? 0 : -1;
+}
+
+int score_decode_record(const unsigned char* p, ScoreEntry* entry) {
+    if (check_record(p) == -1) return -1;
+
+    memset(entry, 0, sizeof(*entry));
+    entry->timestamp = (time_t)(int64_t)get_le64(p);
+    entry->score = (int32_t)get_le32(p + 8);
+    memcpy(entry->name, p + 12, 19);
+    memcpy(entry->mode, p + 32, 9);
+    return 0;
+}
+
+
+// =========================================================
+// 잠금
+// =========================================================
+
+// 점수 파일은 압축할 때 rename 으로 바뀌므로 옆의 잠금 파일에 flock
+// 추가/색인 갱신/변환/압축 교체는 모두 이 잠금 안에서 하고, 읽기는 잠금 없이 함
+// flock 은 열린 파일마다 걸리므로 잠금을 쥔 채로 다시 잠그지 않도록 *_locked 함수만 부름
+static int store_lock(const char* data_path) {
+    char path[520];
+    snprintf(path, sizeof(path), "%s%s", data_path, SCORE_LOCK_SUFFIX);
+
+    int fd = open(path, O_RDWR | O_CREAT, SCORE_FILE_MODE);
+    if (fd == -1) return -1;
+    while (flock(fd, LOCK_EX) == -1) {
+        if (errno != EINTR) {
+            close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+static void store_unlock(int fd) {
+    close(fd);      // 닫으면 flock 도 풀림
+}
+
+// =========================================================
+// 점수 파일 생성 / 변환 / 매핑
+// =========================================================
+
+// 레코드를 모아서 한 번에 쓰기
+typedef struct {
+    int fd;
+    int used;
+    int ok;
+    unsigned char buf[WRITE_CHUNK * SCORE_RECORD_SIZE];
+} RecordWriter;
+
+static RecordWriter writer;
+
+static void writer_flush(RecordWriter* w) {
+    ssize_t len = (ssize_t)w->used * SCORE_RECORD_SIZE;
+    if (w->ok && len > 0) w->ok = write(w->fd, w->buf, len) == len;
+    w->used = 0;
+}
+
+static void writer_put(RecordWriter* w, const unsigned char* record) {
+    memcpy(w->buf + (size_t)w->used * SCORE_RECORD_SIZE, record, SCORE_RECORD_SIZE);
+    if (++w->used == WRITE_CHUNK) writer_flush(w);
+}
+
+// 헤더 자리를 비워 둔 임시 파일 열기 (헤더는 레코드 수가 정해진 뒤에 씀)
+static int writer_open(RecordWriter* w, const char* tmp) {
+    w->fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, SCORE_FILE_MODE);
+    w->used = 0;
+    w->ok = w->fd != -1 && lseek(w->fd, SCORE_HEADER_SIZE, SEEK_SET) == SCORE_HEADER_SIZE;
+    return w->fd == -1 ? -1 : 0;
+}
+
+static int writer_close(RecordWriter* w, uint32_t compacted) {
+    unsigned char header[SCORE_HEADER_SIZE];
+    writer_flush(w);
+    encode_header(header, compacted);
+    if (w->ok) w->ok = pwrite(w->fd, header, sizeof(header), 0) == (ssize_t)sizeof(header);
+    if (w->ok) w->ok = fsync(w->fd) == 0;
+    close(w->fd);
+    return w->ok ? 0 : -1;
+}
+
+// 기록들을 새 파일로 써서 path 로 옮김
+// replace 가 아니면 link 로 옮겨서 이미 있는 파일은 건드리지 않음
+static int write_store(const char* path, const ScoreEntry* entries, long long count, int replace) {
+    char tmp[520];
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", path, (int)getpid());
+    if (writer_open(&writer, tmp) == -1) return -1;
+
+    unsigned char record[SCORE_RECORD_SIZE];
+    for (long long i = 0; i < count; i++) {
+        score_encode_record(record, &entries[i]);
+        writer_put(&writer, record);
+    }
+    int ok = writer_close(&writer, 0) == 0;
+
+    if (ok) {
+        if (replace) ok = rename(tmp, path) == 0;
+        else ok = link(tmp, path) == 0 || errno == EEXIST;
+    }
+    if (!ok || !replace) unlink(tmp);
+    return ok ? 0 : -1;
+}
+
+static int read_header(int fd, unsigned char* header) {
+    ssize_t len = pread(fd, header, SCORE_HEADER_SIZE, 0);
+    return check_header(header, len);
+}
+
+static int convert_locked(const char* data_path) {
+    int fd = open(data_path, O_RDONLY);
+    if (fd == -1) return errno == ENOENT ? 0 : -1;
+
+    unsigned char header[SCORE_HEADER_SIZE];
+    int format = read_header(fd, header);
+    struct stat st;
+    if (format != 0 || fstat(fd, &st) == -1) {
+        close(fd);
+        return format == 1 ? 0 : -1;
+    }
+
+    // v1: 구조체를 그대로 이어 붙인 파일 (끝의 잘린 기록은 버림)
+    long long count = st.st_size / sizeof(ScoreEntry);
+    const ScoreEntry* entries = NULL;
+    if (count > 0) {
+        void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        entries = (const ScoreEntry*)mapped;
+    }
+    close(fd);
+
+    char backup[520];
+    snprintf(backup, sizeof(backup), "%s%s", data_path, SCORE_LEGACY_SUFFIX);
+    if (link(data_path, backup) == -1 && errno != EEXIST) {
+        if (entries) munmap((void*)entries, st.st_size);
+        return -1;
+    }
+
+    int result = write_store(data_path, entries, count, 1);
+    if (entries) munmap((void*)entries, st.st_size);
+    return result;
+}
+
+int score_convert(const char* data_path) {
+    int lock = store_lock(data_path);
+    if (lock == -1) return -1;
+    int result = convert_locked(data_path);
+    store_unlock(lock);
+    return result;
+}
+
+// v2 파일 매핑 (없으면 빈 매핑), 1: v1 이라 변환이 필요함, -1: 실패
+static int map_store(const char* data_path, ScoreMap* map) {
+    memset(map, 0, sizeof(*map));
+
+    int fd = open(data_path, O_RDONLY);
+    if (fd == -1) return errno == ENOENT ? 0 : -1;
+
+    unsigned char header[SCORE_HEADER_SIZE];
+    int format = read_header(fd, header);
+    struct stat st;
+    if (format != 1 || fstat(fd, &st) == -1) {
+        close(fd);
+        return format == 0 ? 1 : -1;
+    }
+
+    void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return -1;
+
+    map->base = (const unsigned char*)mapped;
+    map->size = st.st_size;
+    map->count = (st.st_size - SCORE_HEADER_SIZE) / SCORE_RECORD_SIZE;
+    map->ino = st.st_ino;
+    return 0;
+}
+
+int score_map_open(const char* data_path, ScoreMap* map) {
+    int result = map_store(data_path, map);
+    if (result != 1) return result;
+
+    // 빈 파일 또는 v1 이면 한 번 변환하고 다시 엶
+    if (score_convert(data_path) == -1) return -1;
+    result = map_store(data_path, map);
+    map->converted = 1;
+    return result == 0 ? 0 : -1;
+}
+
+void score_map_close(ScoreMap* map) {
+    if (map->base != NULL) munmap((void*)map->base, map->size);
+    memset(map, 0, sizeof(*map));
+}
+
+static const unsigned char* map_record(const ScoreMap* map, long long i) {
+    return map->base + SCORE_HEADER_SIZE + i * SCORE_RECORD_SIZE;
+}
+
+int score_map_get(const ScoreMap* map, long long i, ScoreEntry* entry) {
+    if (i < 0 || i >= map->count) return -1;
+    return score_decode_record(map_record(map, i), entry);
+}
+
+// =========================================================
+// 상위 N 색인
+// =========================================================
+
+// 점수 내림차순 정렬
+int compareScores(const void* a, const void* b) {
+    ScoreEntry* entryA = (ScoreEntry*)a;
+    ScoreEntry* entryB = (ScoreEntry*)b;
+
+    // 빼서 돌려주면 넘치거나 (time_t 를 int 로) 잘려 순서가 뒤집힐 수 있어 비교 결과만 돌려줌
+    if (entryB->score != entryA->score)
+        return (entryB->score > entryA->score) - (entryB->score < entryA->score);  // 높은 점수 먼저
+
+    return (entryB->timestamp > entryA->timestamp) - (entryB->timestamp < entryA->timestamp);  // 같은 점수면 최신 먼저
+}
+
+// compareScores 순서로 정렬된 top 에 이진 탐색으로 삽입 (max 개 밖이면 버림)
+static void insert_sorted(ScoreEntry* top, int* count, int max, const ScoreEntry* entry) {
+    if (*count == max && compareScores(entry, &top[max - 1]) >= 0) return;
+
+    // 같은 순위의 기존 기록 뒤에 넣음
+    int lo = 0, hi = *count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (compareScores(entry, &top[mid]) < 0) hi = mid;
+        else lo = mid + 1;
+    }
+
+    int moved = *count - lo;
+    if (*count == max) moved--;
+    else (*count)++;
+    memmove(&top[lo + 1], &top[lo], sizeof(ScoreEntry) * moved);
+    top[lo] = *entry;
+}
+
+static void index_path(const char* data_path, char* out, size_t size) {
+    snprintf(out, size, "%s%s", data_path, SCORE_INDEX_SUFFIX);
+}
+
+static void index_reset(ScoreIndex* index, long long ino) {
+    memset(index, 0, sizeof(*index));
+    memcpy(index->magic, index_magic, sizeof(index_magic));
+    index->version = SCORE_INDEX_VERSION;
+    index->entry_size = sizeof(ScoreEntry);
+    index->data_size = SCORE_HEADER_SIZE;
+    index->data_ino = ino;
+}
+
+// 매핑의 레코드 중 색인에 아직 반영하지 않은 것만 반영 (끝의 잘린 레코드는 다음에 반영)
+static void index_scan(ScoreIndex* index, const ScoreMap* map) {
+    long long first = (index->data_size - SCORE_HEADER_SIZE) / SCORE_RECORD_SIZE;
+    ScoreEntry entry;
+
+    for (long long i = first; i < map->count; i++) {
+        if (score_map_get(map, i, &entry) == 0) {
+            index->total++;
+            insert_sorted(index->top, &index->count, SCORE_INDEX_SIZE, &entry);
+        } else {
+            index->corrupt++;
+        }
+    }
+    if (map->count > first) index->data_size = SCORE_HEADER_SIZE + map->count * SCORE_RECORD_SIZE;
+}
+
+// 형식이 맞는 색인이면 0
+static int index_read(const char* data_path, ScoreIndex* index) {
+    char path[512];
+    index_path(data_path, path, sizeof(path));
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return -1;
+    ssize_t n = read(fd, index, sizeof(*index));
+    close(fd);
+
+    if (n != (ssize_t)sizeof(*index) ||
+        memcmp(index->magic, index_magic, sizeof(index_magic)) != 0 ||
+        index->version != SCORE_INDEX_VERSION ||
+        index->entry_size != (int)sizeof(ScoreEntry) ||
+        index->count < 0 || index->count > SCORE_INDEX_SIZE ||
+        index->data_size < SCORE_HEADER_SIZE ||
+        (index->data_size - SCORE_HEADER_SIZE) % SCORE_RECORD_SIZE != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// 색인이 지금 점수 파일의 완전한 레코드를 모두 반영하고 있는지
+static int index_fresh(const ScoreIndex* index, const struct stat* st) {
+    return index->data_ino == (long long)st->st_ino &&
+           index->data_size <= (long long)st->st_size &&
+           index->data_size + SCORE_RECORD_SIZE > (long long)st->st_size;
+}
+
+// 임시 파일에 쓴 뒤 rename 으로 교체 (읽는 쪽은 항상 완전한 색인을 봄)
+static int index_save(const char* data_path, const ScoreIndex* index) {
+    char path[512], tmp[520];
+    index_path(data_path, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid());
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, SCORE_FILE_MODE);
+    if (fd == -1) return -1;
+    ssize_t written = write(fd, index, sizeof(*index));
+    close(fd);
+
+    if (written != (ssize_t)sizeof(*index) || rename(tmp, path) == -1) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+// 점수 파일이 바뀌었으면 (다른 파일로 교체, 줄어듦) 처음부터, 늘었으면 늘어난 부분만 반영
+static int index_refresh_locked(const char* data_path, ScoreIndex* index, int rebuild) {
+    if (convert_locked(data_path) == -1) return -1;
+
+    struct stat st;
+    if (stat(data_path, &st) == -1) {
+        index_reset(index, 0);
+        return errno == ENOENT ? 0 : -1;
+    }
+
+    if (rebuild || index_read(data_path, index) == -1 ||
+        index->data_ino != (long long)st.st_ino ||
+        index->data_size > (long long)st.st_size) {
+        index_reset(index, st.st_ino);
+    } else if (index_fresh(index, &st)) {
+        return 0;
+    }
+
+    ScoreMap map;
+    if (map_store(data_path, &map) != 0) return -1;
+    index_scan(index, &map);
+    score_map_close(&map);
+
+    index_save(data_path, index);
+    return 0;
+}
+
+int score_index_rebuild(const char* data_path, ScoreIndex* index) {
+    int lock = store_lock(data_path);
+    if (lock == -1) return -1;
+    int result = index_refresh_locked(data_path, index, 1);
+    store_unlock(lock);
+    return result;
+}
+
+int score_index_load(const char* data_path, ScoreIndex* index) {
+    struct stat st;
+    if (stat(data_path, &st) == -1) {
+        index_reset(index, 0);
+        return errno == ENOENT ? 0 : -1;
+    }
+
+    // 대부분은 잠금 없이 색인 파일 하나만 읽고 끝남
+    if (index_read(data_path, index) == 0 && index_fresh(index, &st)) return 0;
+
+    int lock = store_lock(data_path);
+    if (lock == -1) return -1;
+    int result = index_refresh_locked(data_path, index, 0);
+    store_unlock(lock);
+    return result;
+}
+
+// =========================================================
+// 통계
+// =========================================================
+
+// 통계 파일: 헤더 뒤에 (이름, 모드) 키의 열린 주소 해시 테이블, 읽기/쓰기 모두 mmap
+// 이름이 "" 인 키는 그 모드 전체. 압축으로 지워진 기록도 통계에는 남음
+typedef struct {
+    char magic[4];              // "SWST"
+    int version;
+    int slot_size;              // sizeof(StatsSlot) (다른 빌드가 만든 파일은 다시 만듦)
+    int capacity;               // 2 의 거듭제곱
+    int used;
+    int reserved;
+    long long data_ino;         // 반영한 점수 파일
+    long long data_size;        // 반영한 점수 파일 크기 (헤더 포함)
+} StatsHeader;
+
+typedef struct {
+    char name[20];
+    char mode[10];
+    char used;
+    long long games;
+    long long sum;
+    int best;
+    unsigned int buckets[SCORE_SKETCH_BUCKETS];
+} StatsSlot;
+
+typedef struct {
+    StatsHeader* header;
+    StatsSlot* slots;
+    size_t size;
+} StatsMap;
+
+static const char stats_magic[4] = { 'S', 'W', 'S', 'T' };
+
+// 해석한 기록은 이름/모드 뒤쪽이 0 으로 채워져 있으므로 배열 전체로 비교
+unsigned int score_key_hash(const ScoreEntry* key) {
+    unsigned int h = 2166136261u;   // FNV-1a
+    for (size_t i = 0; i < sizeof(key->name); i++) h = (h ^ (unsigned char)key->name[i]) * 16777619u;
+    for (size_t i = 0; i < sizeof(key->mode); i++) h = (h ^ (unsigned char)key->mode[i]) * 16777619u;
+    return h;
+}
+
+int score_key_equal(const ScoreEntry* a, const ScoreEntry* b) {
+    return memcmp(a->name, b->name, sizeof(a->name)) == 0 && memcmp(a->mode, b->mode, sizeof(a->mode)) == 0;
+}
+
+void score_make_key(ScoreEntry* key, const char* name, const char* mode) {
+    memset(key, 0, sizeof(*key));
+    if (name != NULL) memcpy(key->name, name, strnlen(name, sizeof(key->name) - 1));
+    if (mode != NULL) memcpy(key->mode, mode, strnlen(mode, sizeof(key->mode) - 1));
+}
+
+// 값의 로그 구간: 8 미만은 값 그대로, 그 위는 2 의 거듭제곱 구간마다 8 칸
+static int sketch_bucket(int value) {
+    if (value < 0) value = 0;
+    if (value >= 1 << SCORE_SKETCH_MAX_BITS) value = (1 << SCORE_SKETCH_MAX_BITS) - 1;
+    if (value < 8) return value;
+
+    int e = 31 - __builtin_clz((unsigned int)value);
+    return 8 + (e - 3) * 8 + ((value >> (e - 3)) & 7);
+}
+
+static int sketch_low(int bucket) {
+    if (bucket < 8) return bucket;
+    int e = (bucket - 8) / 8 + 3;
+    return (8 + (bucket - 8) % 8) << (e - 3);
+}
+
+static int sketch_width(int bucket) {
+    return bucket < 8 ? 1 : 1 << ((bucket - 8) / 8);
+}
+
+static void stats_path(const char* data_path, char* out, size_t size) {
+    snprintf(out, size, "%s%s", data_path, SCORE_STATS_SUFFIX);
+}
+
+static size_t stats_size(int capacity) {
+    return sizeof(StatsHeader) + (size_t)capacity * sizeof(StatsSlot);
+}
+
+static void stats_close(StatsMap* map) {
+    if (map->header != NULL) munmap(map->header, map->size);
+    memset(map, 0, sizeof(*map));
+}
+
+static int stats_open(const char* path, StatsMap* map, int writable) {
+    memset(map, 0, sizeof(*map));
+    int fd = open(path, writable ? O_RDWR : O_RDONLY);
+    if (fd == -1) return -1;
+
+    struct stat st;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(StatsHeader)) {
+        mapped = mmap(NULL, st.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) return -1;
+
+    map->header = (StatsHeader*)mapped;
+    map->slots = (StatsSlot*)(map->header + 1);
+    map->size = st.st_size;
+
+    const StatsHeader* h = map->header;
+    if (memcmp(h->magic, stats_magic, sizeof(stats_magic)) != 0 ||
+        h->version != SCORE_STATS_VERSION ||
+        h->slot_size != (int)sizeof(StatsSlot) ||
+        h->capacity <= 0 || (h->capacity & (h->capacity - 1)) != 0 ||
+        stats_size(h->capacity) != map->size) {
+        stats_close(map);
+        return -1;
+    }
+    return 0;
+}
+
+static StatsSlot* stats_slot(StatsSlot* slots, int capacity, const ScoreEntry* key) {
+    unsigned int i = score_key_hash(key) & (capacity - 1);
+    while (slots[i].used &&
+           (memcmp(slots[i].name, key->name, sizeof(key->name)) != 0 ||
+            memcmp(slots[i].mode, key->mode, sizeof(key->mode)) != 0)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &slots[i];
+}
+
+// 빈 (또는 old 를 옮겨 담은) 통계 파일을 capacity 칸으로 새로 만들어 교체
+static int stats_create(const char* path, int capacity, const StatsMap* old, long long ino) {
+    char tmp[520];
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", path, (int)getpid());
+
+    size_t size = stats_size(capacity);
+    int fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, SCORE_FILE_MODE);
+    if (fd == -1) return -1;
+    void* mapped = ftruncate(fd, size) == 0 ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                                             : MAP_FAILED;
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        unlink(tmp);
+        return -1;
+    }
+
+    StatsHeader* header = (StatsHeader*)mapped;
+    StatsSlot* slots = (StatsSlot*)(header + 1);
+    memcpy(header->magic, stats_magic, sizeof(stats_magic));
+    header->version = SCORE_STATS_VERSION;
+    header->slot_size = sizeof(StatsSlot);
+    header->capacity = capacity;
+    header->data_ino = ino;
+    header->data_size = SCORE_HEADER_SIZE;
+
+    if (old != NULL) {
+        header->data_ino = old->header->data_ino;
+        header->data_size = old->header->data_size;
+        header->used = old->header->used;
+        for (int i = 0; i < old->header->capacity; i++) {
+            if (!old->slots[i].used) continue;
+            ScoreEntry key;
+            score_make_key(&key, NULL, NULL);
+            memcpy(key.name, old->slots[i].name, sizeof(key.name));
+            memcpy(key.mode, old->slots[i].mode, sizeof(key.mode));
+            *stats_slot(slots, capacity, &key) = old->slots[i];
+        }
+    }
+
+    int ok = msync(mapped, size, MS_SYNC) == 0;
+    munmap(mapped, size);
+    if (!ok || rename(tmp, path) == -1) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+static int stats_add(const char* path, StatsMap* map, const ScoreEntry* entry) {
+    ScoreEntry keys[2];
+    score_make_key(&keys[0], entry->name, entry->mode);
+    score_make_key(&keys[1], NULL, entry->mode);      // 모드 전체
+
+    for (int k = 0; k < 2; k++) {
+        StatsSlot* slot = stats_slot(map->slots, map->header->capacity, &keys[k]);
+        if (!slot->used) {
+            // 70% 를 넘기 전에 두 배로 늘린 파일로 교체
+            if ((map->header->used + 1) * 10 > map->header->capacity * 7) {
+                if (stats_create(path, map->header->capacity * 2, map, 0) == -1) return -1;
+                stats_close(map);
+                if (stats_open(path, map, 1) == -1) return -1;
+                slot = stats_slot(map->slots, map->header->capacity, &keys[k]);
+            }
+            memcpy(slot->name, keys[k].name, sizeof(slot->name));
+            memcpy(slot->mode, keys[k].mode, sizeof(slot->mode));
+            slot->best = entry->score;
+            slot->used = 1;
+            map->header->used++;
+        }
+        slot->games++;
+        slot->sum += entry->score;
+        if (entry->score > slot->best) slot->best = entry->score;
+        slot->buckets[sketch_bucket(entry->score)]++;
+    }
+    return 0;
+}
+
+static int stats_fresh(const StatsMap* map, const struct stat* st) {
+    return map->header->data_ino == (long long)st->st_ino &&
+           map->header->data_size <= (long long)st->st_size &&
+           map->header->data_size + SCORE_RECORD_SIZE > (long long)st->st_size;
+}
+
+// 점수 파일에 새로 붙은 레코드를 통계에 반영
+// 통계가 없거나 모르는 점수 파일이면 지금 남은 레코드로 새로 만듦
+static int stats_refresh_locked(const char* data_path) {
+    struct stat st;
+    if (stat(data_path, &st) == -1) return errno == ENOENT ? 0 : -1;
+
+    char path[512];
+    stats_path(data_path, path, sizeof(path));
+    StatsMap stats;
+    if (stats_open(path, &stats, 1) == 0) {
+        if (stats_fresh(&stats, &st)) {
+            stats_close(&stats);
+            return 0;
+        }
+        if (stats.header->data_ino != (long long)st.st_ino ||
+            stats.header->data_size > (long long)st.st_size) stats_close(&stats);
+    }
+    if (stats.header == NULL) {
+        if (stats_create(path, SCORE_STATS_INIT, NULL, st.st_ino) == -1 ||
+            stats_open(path, &stats, 1) == -1) return -1;
+    }
+
+    ScoreMap map;
+    if (map_store(data_path, &map) != 0) {
+        stats_close(&stats);
+        return -1;
+    }
+    int result = 0;
+    long long first = (stats.header->data_size - SCORE_HEADER_SIZE) / SCORE_RECORD_SIZE;
+    for (long long i = first; i < map.count && result == 0; i++) {
+        ScoreEntry entry;
+        if (score_map_get(&map, i, &entry) == 0) result = stats_add(path, &stats, &entry);
+    }
+    if (result == 0 && map.count > first) {
+        stats.header->data_size = SCORE_HEADER_SIZE + map.count * SCORE_RECORD_SIZE;
+    }
+    score_map_close(&map);
+    stats_close(&stats);
+    return result;
+}
+
+// 압축으로 교체된 점수 파일을 이미 반영한 것으로 표시 (지워진 기록의 통계 유지)
+static void stats_rebase_locked(const char* data_path) {
+    char path[512];
+    struct stat st;
+    StatsMap stats;
+    stats_path(data_path, path, sizeof(path));
+    if (stat(data_path, &st) == -1 || stats_open(path, &stats, 1) == -1) return;
+
+    stats.header->data_ino = st.st_ino;
+    stats.header->data_size = SCORE_HEADER_SIZE +
+        (st.st_size - SCORE_HEADER_SIZE) / SCORE_RECORD_SIZE * SCORE_RECORD_SIZE;
+    stats_close(&stats);
+}
+
+// 최신 통계를 읽기 전용으로 매핑 (뒤처져 있으면 잠그고 반영한 뒤)
+static int stats_load(const char* data_path, StatsMap* stats) {
+    struct stat st;
+    char path[512];
+    stats_path(data_path, path, sizeof(path));
+    if (stat(data_path, &st) == -1) return -1;
+
+    if (stats_open(path, stats, 0) == 0) {
+        if (stats_fresh(stats, &st)) return 0;
+        stats_close(stats);
+    }
+
+    int lock = store_lock(data_path);
+    if (lock == -1) return -1;
+    int result = convert_locked(data_path) == 0 ? stats_refresh_locked(data_path) : -1;
+    store_unlock(lock);
+    return result == 0 ? stats_open(path, stats, 0) : -1;
+}
+
+// 누적 분포에서 q 분위 (구간 가운데 값, 최고 기록을 넘지 않게)
+static int sketch_quantile(const StatsSlot* slot, double q) {
+    long long target = (long long)(q * (slot->games - 1)) + 1;
+    long long seen = 0;
+    for (int i = 0; i < SCORE_SKETCH_BUCKETS; i++) {
+        seen += slot->buckets[i];
+        if (seen >= target) {
+            int value = sketch_low(i) + (sketch_width(i) - 1) / 2;
+            return value < slot->best ? value : slot->best;
+        }
+    }
+    return slot->best;
+}
+
+int score_stats(const char* data_path, const char* name, const char* mode, ScoreStats* out) {
+    StatsMap stats;
+    if (stats_load(data_path, &stats) == -1) return -1;
+
+    ScoreEntry key;
+    score_make_key(&key, name, mode);
+    const StatsSlot* slot = stats_slot(stats.slots, stats.header->capacity, &key);
+    int found = slot->used && slot->games > 0;
+    if (found) {
+        out->games = slot->games;
+        out->best = slot->best;
+        out->mean = (double)slot->sum / slot->games;
+        out->p50 = sketch_quantile(slot, 0.50);
+        out->p90 = sketch_quantile(slot, 0.90);
+        out->p99 = sketch_quantile(slot, 0.99);
+    }
+    stats_close(&stats);
+    return found ? 0 : -1;
+}
+
+double score_stats_beaten(const char* data_path, const char* mode, int score) {
+    StatsMap stats;
+    if (stats_load(data_path, &stats) == -1) return -1;
+
+    ScoreEntry key;
+    score_make_key(&key, NULL, mode);
+    const StatsSlot* slot = stats_slot(stats.slots, stats.header->capacity, &key);
+    double beaten = -1;
+    if (slot->used && slot->games > 0) {
+        // score 가 속한 구간은 구간 안에 고르게 퍼져 있다고 보고 나눔
+        int bucket = sketch_bucket(score);
+        double below = 0;
+        for (int i = 0; i < bucket; i++) below += slot->buckets[i];
+        below += slot->buckets[bucket] * (double)(score - sketch_low(bucket)) / sketch_width(bucket);
+        beaten = below / slot->games;
+    }
+    stats_close(&stats);
+    return beaten;
+}
+
+int score_last(const char* data_path, ScoreEntry* entry) {
+    ScoreMap map;
+    if (score_map_open(data_path, &map) == -1) return -1;
+    int result = -1;
+    for (long long i = map.count - 1; i >= 0 && result == -1; i--) {
+        result = score_map_get(&map, i, entry);
+    }
+    score_map_close(&map);
+    return result;
+}
+
+static int open_append_locked(const char* data_path) {
+    // v1 이면 먼저 변환하고, 처음이면 헤더만 있는 파일을 만듦
+    if (convert_locked(data_path) == -1) return -1;
+    int fd = open(data_path, O_WRONLY | O_APPEND);
+    if (fd == -1 && errno == ENOENT) {
+        if (write_store(data_path, NULL, 0, 0) == -1) return -1;
+        fd = open(data_path, O_WRONLY | O_APPEND);
+    }
+    if (fd == -1) return -1;
+
+    // 이전에 쓰다 만 레코드가 끝에 있으면 잘라내야 이후 레코드 경계가 맞음
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= SCORE_HEADER_SIZE &&
+        (st.st_size - SCORE_HEADER_SIZE) % SCORE_RECORD_SIZE != 0) {
+        ftruncate(fd, st.st_size - (st.st_size - SCORE_HEADER_SIZE) % SCORE_RECORD_SIZE);
+    }
+    return fd;
+}
+
+int score_open_append(const char* data_path) {
+    int lock = store_lock(data_path);
+    if (lock == -1) return -1;
+    int fd = open_append_locked(data_path);
+    store_unlock(lock);
+    return fd;
+}
+
+static int append_locked(const char* data_path, const ScoreEntry* entry) {
+    int fd = open_append_locked(data_path);
+    if (fd == -1) return -1;
+
+    unsigned char record[SCORE_RECORD_SIZE];
+    score_encode_record(record, entry);
+    ssize_t written = write(fd, record, sizeof(record)); // 파일에 데이터 기록
+    close(fd);
+    if (written != (ssize_t)sizeof(record)) return -1;
+
+    // 방금 붙인 레코드는 색인/통계의 꼬리 반영으로 들어감
+    ScoreIndex index;
+    int result = index_refresh_locked(data_path, &index, 0);
+    if (stats_refresh_locked(data_path) == -1) result = -1;
+    return result;
+}
+
+int score_append(const char* data_path, const ScoreEntry* entry) {
+    int lock = store_lock(data_path);
+    if (lock == -1) return -1;
+    int result = append_locked(data_path, entry);
+    store_unlock(lock);
+    return result;
+}
+
+long score_best(const char* data_path) {
+    ScoreIndex index;
+    if (score_index_load(data_path, &index) == -1 || index.count == 0) return 0;
+    return index.top[0].score > 0 ? index.top[0].score : 0;
+}
+
+int score_top(const char* data_path, ScoreEntry* out, int max) {
+    ScoreIndex index;
+    if (score_index_load(data_path, &index) == -1) return 0;
+
+    int count = index.count < max ? index.count : max;
+    memcpy(out, index.top, sizeof(ScoreEntry) * count);
+    return count;
+}
+
+// =========================================================
+// 압축
+// =========================================================
+
+// 플레이어/모드별로 남길 기록
+typedef struct {
+    char name[20];
+    char mode[10];
+    int used;
+    int count;                  // best 에 들어 있는 기록 수
+    int ties;                   // best 의 마지막 순위와 같은 기록 중 아직 내보내지 않은 수
+    ScoreEntry* best;           // compareScores 순서, 최대 keep 개
+} KeepBucket;
+
+typedef struct {
+    KeepBucket* buckets;
+    int capacity;               // 2 의 거듭제곱
+    int used;
+    int keep;
+} KeepTable;
+
+static KeepBucket* keep_slot(KeepBucket* buckets, int capacity, const ScoreEntry* entry) {
+    unsigned int i = score_key_hash(entry) & (capacity - 1);
+    while (buckets[i].used &&
+           (memcmp(buckets[i].name, entry->name, sizeof(entry->name)) != 0 ||
+            memcmp(buckets[i].mode, entry->mode, sizeof(entry->mode)) != 0)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &buckets[i];
+}
+
+static KeepBucket* keep_find(KeepTable* table, const ScoreEntry* entry) {
+    if ((table->used + 1) * 10 > table->capacity * 7) {
+        int capacity = table->capacity * 2;
+        KeepBucket* buckets = calloc(capacity, sizeof(KeepBucket));
+        if (buckets == NULL) return NULL;
+        for (int i = 0; i < table->capacity; i++) {
+            if (!table->buckets[i].used) continue;
+            ScoreEntry key;
+            memcpy(key.name, table->buckets[i].name, sizeof(key.name));
+            memcpy(key.mode, table->buckets[i].mode, sizeof(key.mode));
+            *keep_slot(buckets, capacity, &key) = table->buckets[i];
+        }
+        free(table->buckets);
+        table->buckets = buckets;
+        table->capacity = capacity;
+    }
+
+    KeepBucket* bucket = keep_slot(table->buckets, table->capacity, entry);
+    if (!bucket->used) {
+        bucket->best = malloc(sizeof(ScoreEntry) * table->keep);
+        if (bucket->best == NULL) return NULL;
+        bucket->used = 1;
+        memcpy(bucket->name, entry->name, sizeof(bucket->name));
+        memcpy(bucket->mode, entry->mode, sizeof(bucket->mode));
+        table->used++;
+    }
+    return bucket;
+}
+
+static void keep_free(KeepTable* table) {
+    for (int i = 0; i < table->capacity; i++) free(table->buckets[i].best);
+    free(table->buckets);
+}
+
+int score_compact_needed(const char* data_path) {
+    int fd = open(data_path, O_RDONLY);
+    if (fd == -1) return 0;
+
+    unsigned char header[SCORE_HEADER_SIZE];
+    int format = read_header(fd, header);
+    struct stat st;
+    int ok = fstat(fd, &st) == 0;
+    close(fd);
+    if (!ok || format == -1) return 0;
+
+    // 마지막 압축 뒤로 기록이 두 배 이상 늘었을 때만 (압축 비용을 추가 횟수로 나누면 상수)
+    long long count, compacted = 0;
+    if (format == 1) {
+        count = (st.st_size - SCORE_HEADER_SIZE) / SCORE_RECORD_SIZE;
+        compacted = get_le32(header + 24);
+    } else {
+        count = st.st_size / sizeof(ScoreEntry);
+    }
+    return count >= SCORE_COMPACT_MIN && count > compacted * 2;
+}
+
+long long score_compact(const char* data_path, int keep) {
+    if (keep <= 0) return -1;
+
+    // 1단계 (잠금 없음): 매핑해 둔 시점의 레코드로 플레이어/모드별 상위 keep 개를 고름
+    ScoreMap map;
+    if (score_map_open(data_path, &map) == -1) return -1;
+    if (map.base == NULL) return 0;
+
+    KeepTable table = { calloc(KEEP_TABLE_INIT, sizeof(KeepBucket)), KEEP_TABLE_INIT, 0, keep };
+    int ok = table.buckets != NULL;
+    ScoreEntry entry;
+    for (long long i = 0; ok && i < map.count; i++) {
+        if (score_map_get(&map, i, &entry) == -1) continue;
+        KeepBucket* bucket = keep_find(&table, &entry);
+        if (bucket == NULL) ok = 0;
+        else insert_sorted(bucket->best, &bucket->count, keep, &entry);
+    }
+    for (int b = 0; ok && b < table.capacity; b++) {
+        KeepBucket* bucket = &table.buckets[b];
+        if (!bucket->used) continue;
+        for (int i = 0; i < bucket->count; i++) {
+            if (compareScores(&bucket->best[i], &bucket->best[bucket->count - 1]) == 0) bucket->ties++;
+        }
+    }
+
+    // 2단계 (잠금 없음): 고른 레코드를 원래 순서대로 새 파일에 그대로 복사
+    char tmp[520];
+    snprintf(tmp, sizeof(tmp), "%s.%d.compact", data_path, (int)getpid());
+    if (ok) ok = writer_open(&writer, tmp) == 0;
+
+    long long kept = 0;
+    for (long long i = 0; ok && i < map.count; i++) {
+        if (score_map_get(&map, i, &entry) == -1) continue;
+        KeepBucket* bucket = keep_slot(table.buckets, table.capacity, &entry);
+        int order = compareScores(&entry, &bucket->best[bucket->count - 1]);
+        if (order > 0 || (order == 0 && bucket->ties == 0)) continue;
+        if (order == 0) bucket->ties--;
+        writer_put(&writer, map_record(&map, i));
+        kept++;
+    }
+    long long scanned = map.count;
+    long long snapshot_ino = map.ino;
+    score_map_close(&map);
+    if (table.buckets != NULL) keep_free(&table);
+
+    // 3단계 (잠금): 그 사이 붙은 레코드를 옮기고 교체
+    int lock = ok ? store_lock(data_path) : -1;
+    if (lock == -1) {
+        if (ok) close(writer.fd);
+        unlink(tmp);
+        return -1;
+    }
+
+    // 다른 프로세스가 먼저 압축했으면 이번 결과는 버림
+    if (map_store(data_path, &map) != 0 || map.ino != snapshot_ino) {
+        score_map_close(&map);
+        store_unlock(lock);
+        close(writer.fd);
+        unlink(tmp);
+        return 0;
+    }
+    for (long long i = scanned; i < map.count; i++) {
+        if (check_record(map_record(&map, i)) == 0) {
+            writer_put(&writer, map_record(&map, i));
+            kept++;
+        }
+    }
+    long long removed = map.count - kept;
+    score_map_close(&map);
+
+    // 지워질 기록까지 통계에 반영해 두고, 교체 뒤에는 새 파일을 반영한 것으로 표시
+    stats_refresh_locked(data_path);
+    ok = writer_close(&writer, (uint32_t)kept) == 0 && rename(tmp, data_path) == 0;
+    if (ok) {
+        ScoreIndex index;
+        index_refresh_locked(data_path, &index, 1);
+        stats_rebase_locked(data_path);
+    } else {
+        unlink(tmp);
+    }
+    store_unlock(lock);
+    return ok ? removed : -1;
+}
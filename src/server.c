@@ -1,60 +1,354 @@
 #include <stdio.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <time.h>
 #include <signal.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
 #include "game_logic.h"
 #include "item.h"
 #include "common.h"
+#include "lockstep.h"
+#include "net.h"
+#include "ring.h"
+#include "profile.h"
+#include "metrics.h"
+#include "trace.h"
+#include "lagcomp.h"
+#include "matchlog.h"
+#include "logger.h"
+
+#define INPUT_QUEUE_SIZE 64     // 연결당 입력 큐 크기
+
+// 연결 스레드 -> 틱 스레드 입력 이벤트
+typedef struct {
+    PacketType type;            // PLAYER_MOVE, ITEM_USE
+    int x, y;
+    int item_type;
+    int frame;
+    int view_frame;             // 입력을 낼 때 클라이언트 화면에 그려져 있던 프레임
+    InputTrace trace;           // 지연 측정 (input_id 가 0 이면 없음)
+    LockstepInput lockstep;     // 락스텝 모드 입력
+} InputEvent;
 
 GameState state;
+int lockstep_mode = 0;      // --lockstep: 입력만 중계하고 각 클라이언트가 시뮬레이션
+int tick_hz = TICK_HZ;              // --tick-hz: 틱 속도 (게임 설정의 시간은 이에 맞춰 틱으로 환산)
+long long tick_usec = TICK_USEC;    // 틱 주기 (1000000 / tick_hz)
+Lockstep lockstep;
+LagComp lagcomp;
+int lag_comp_ms = LAGCOMP_DEFAULT_MS;   // --lag-comp-ms: 피격 판정 되감기 상한 (0 이면 끔)
 int client_socket[MAX_PLAYERS] = {0};
 pthread_mutex_t game_mutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t game_cond = PTHREAD_COND_INITIALIZER;
 volatile int game_running = 1;
-volatile sig_atomic_t special_wave = 0;
-volatile sig_atomic_t redzone = 0;
 
 // 클라이언트 스레드 (최대 2개)
 pthread_t client_threads[MAX_PLAYERS] = {0};
 
-//화살 증가, 레드존 이벤트 처리를 위한 알람 핸들러
-void event(int sig) {
+// 연결마다 하나씩 (생산자: client_handler, 소비자: game_loop)
+// 입력 처리와 틱이 서로를 막지 않고, 입력은 항상 틱 경계에서 적용됨
+Ring input_queue[MAX_PLAYERS];
+atomic_llong input_drops[MAX_PLAYERS];     // 큐가 가득 차 버린 입력 수 (연결 스레드가 올리고 틱 스레드가 읽음)
+volatile int send_failed[MAX_PLAYERS] = {0};    // 전송 실패로 끊은 연결 (해제 원인 기록용)
 
-    signal(SIGALRM, event);
-    static int alarmCount = 0;
-    alarmCount++;
+// 진행 중인 판의 집계 (틱 스레드 전용, 판이 끝나면 matchlog 로 넘김)
+typedef struct {
+    long long started;              // 유닉스 초
+    long long start_ns;
+    Player start[MAX_PLAYERS];      // 시작 시 플레이어 (아이템/목숨 차이로 사용량과 피격을 계산)
+    long long drops_start[MAX_PLAYERS];
+    int moves[MAX_PLAYERS];
+    int ticks;
+    int overruns;
+    long long tick_sum_ns;
+    long long tick_max_ns;
+} MatchTally;
 
-    // 10초 마다 화살 증가
-    if (alarmCount % 1 == 0) {
-        state.special_wave = 60;
-    }
+MatchTally tally;
 
-    // 20초마다 레드존
-    if (alarmCount % 2 == 0) {
-       redZone(&state, GAME_WIDTH, GAME_HEIGHT);
-    }
-    alarm(10);
+// 전송에 실패한 연결은 스트림이 어긋났거나 상대가 죽은 것이므로 끊음
+// (읽고 있던 client_handler 가 깨어나 자리를 비움)
+static void drop_client(int id) {
+    if (!send_failed[id]) log_warn("플레이어 %d 전송 실패, 연결 끊음", id);
+    send_failed[id] = 1;
+    shutdown(client_socket[id], SHUT_RDWR);
+    if (metrics_enabled) metrics.send_errors++;
 }
 
 // 브로드캐스트
 void send_packet(Packet* packet) {
+    long long t = trace_begin();
     for (int i = 0; i < MAX_PLAYERS; i++) {
         if (client_socket[i] > 0) {
-            write(client_socket[i], packet, sizeof(Packet));
+            if (net_write_full(client_socket[i], packet, sizeof(Packet)) == 0) {
+                metrics_packet_out(packet->type, sizeof(Packet));
+            } else {
+                drop_client(i);
+            }
+        }
+    }
+    trace_end(packet_name(packet->type), t, packet->frame);
+}
+
+// 락스텝 입력 프레임 중계 (보낸 플레이어 제외)
+void relay_lockstep(const LockstepInput* input, int from) {
+    long long t = trace_begin();
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (i != from && client_socket[i] > 0) {
+            if (lockstep_send(client_socket[i], input) == 0) {
+                metrics_packet_out(METRICS_LOCKSTEP, sizeof(LockstepInput));
+            } else {
+                drop_client(i);
+            }
+        }
+    }
+    trace_end(packet_name(METRICS_LOCKSTEP), t, input->frame);
+}
+
+// 입력 이벤트 적용 (game_mutex 보유 상태)
+static void apply_input(int id, const InputEvent* ev) {
+    if (lockstep_mode) {
+        // 거절한 입력은 다른 피어에게도 중계하지 않음 (같은 입력으로 진행해야 상태가 같아짐)
+        if (lockstep_add(&lockstep, &ev->lockstep, state.frame) != 0) {
+            log_warn("플레이어 %d 락스텝 입력 버림 (프레임 %d, 현재 %d)", id, ev->lockstep.frame, state.frame);
+            return;
+        }
+        relay_lockstep(&ev->lockstep, id);
+        return;
+    }
+
+    // 번호가 붙은 입력은 적용 시각과 함께 다음 STATE_UPDATE 로 돌려줌
+    if (ev->trace.input_id != 0) {
+        state.player[id].ack_trace = ev->trace;
+        state.player[id].ack_trace.apply_ns = now_ns();
+    }
+
+    // 클라이언트 화면에 그려져 있던 프레임보다 늦게 적용되면 그만큼 피격 판정을 되감음
+    // (앞서 예측하는 클라이언트는 서버보다 앞선 화살을 보고 있으므로 거의 되감지 않음)
+    if (ev->type == PLAYER_MOVE || ev->type == ITEM_USE) {
+        lagcomp_input(&lagcomp, id, ev->view_frame, state.frame);
+    }
+
+    switch (ev->type) {
+        case PLAYER_MOVE:
+            tally.moves[id]++;
+            state.player[id].x = ev->x;
+            state.player[id].y = ev->y;
+            state.player[id].ack_frame = ev->frame;
+            break;
+            
+        case ITEM_USE:
+            switch (ev->item_type) {
+                case 1: invincible_item(&state.player[id], &state.config); break;
+                case 2: heal_item(&state.player[id]); break;
+                case 3: slow_item(&state.player[id], &state.config); break;
+            }
+            state.player[id].ack_frame = ev->frame;
+            break;
+        default: break;
+    }
+}
+
+// 틱 시작 시 쌓인 입력을 플레이어 ID 순서, 도착 순서대로 적용 (game_mutex 보유 상태)
+static void drain_inputs(void) {
+    InputEvent ev;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        while (ring_pop(&input_queue[i], &ev) == 0) {
+            apply_input(i, &ev);
         }
     }
 }
 
+// update_game 의 충돌 판정 (game_mutex 보유 상태)
+static void lag_compensated_collisions(GameState* game_state, int width, int height) {
+    (void)width;
+    (void)height;
+    lagcomp_collisions(&lagcomp, game_state);
+}
+
+// 판 시작 (game_mutex 보유 상태)
+static void match_begin(void) {
+    memset(&tally, 0, sizeof(tally));
+    tally.started = time(NULL);
+    tally.start_ns = now_ns();
+    memcpy(tally.start, state.player, sizeof(tally.start));
+    for (int i = 0; i < MAX_PLAYERS; i++) tally.drops_start[i] = atomic_load_explicit(&input_drops[i], memory_order_relaxed);
+}
+
+static void match_tick(long long elapsed_ns) {
+    tally.ticks++;
+    tally.tick_sum_ns += elapsed_ns;
+    if (elapsed_ns > tally.tick_max_ns) tally.tick_max_ns = elapsed_ns;
+    if (elapsed_ns > tick_usec * 1000LL) {
+        tally.overruns++;
+        log_debug("틱 예산 초과 %lldus (프레임 %d)", elapsed_ns / 1000, state.frame);
+    }
+}
+
+// 판 요약을 기록 스레드에 넘김 (대기열에 넣기만 하므로 디스크를 기다리지 않음)
+static void match_end(int winner, int disconnected) {
+    MatchRecord record;
+    memset(&record, 0, sizeof(record));
+    record.started = tally.started;
+    record.duration_ms = (int)((now_ns() - tally.start_ns) / 1000000);
+    record.frames = state.frame;
+    record.tick_hz = tick_hz;
+    record.winner = winner;
+    if (lockstep_mode) record.flags |= MATCHLOG_LOCKSTEP;
+    if (disconnected) record.flags |= MATCHLOG_DISCONNECT;
+    if (lagcomp.max_ticks > 0 && !lockstep_mode) record.flags |= MATCHLOG_LAGCOMP;
+    record.ticks = tally.ticks;
+    record.tick_mean_ns = tally.ticks ? (int)(tally.tick_sum_ns / tally.ticks) : 0;
+    record.tick_max_ns = (int)tally.tick_max_ns;
+    record.tick_overruns = tally.overruns;
+    record.arrows_spawned = state.stats.arrows_spawned;
+    record.spawn_drops = state.stats.spawn_drops;
+    memcpy(record.damage, state.stats.damage, sizeof(record.damage));
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        const Player* p = &state.player[i];
+        const Player* s = &tally.start[i];
+        MatchPlayer* mp = &record.player[i];
+        mp->flags = p->connected ? MATCHLOG_CONNECTED : 0;
+        mp->lives = p->lives;
+        mp->score = p->score;
+        mp->alive_ticks = p->alive_ticks;
+        mp->items_used[0] = s->invincible_item - p->invincible_item;
+        mp->items_used[1] = s->heal_item - p->heal_item;
+        mp->items_used[2] = s->slow_item - p->slow_item;
+        mp->hits = s->lives + mp->items_used[1] - p->lives;   // 회복한 만큼 더 맞음
+        mp->moves = tally.moves[i];
+        mp->input_drops = (int)(atomic_load_explicit(&input_drops[i], memory_order_relaxed) - tally.drops_start[i]);
+    }
+    matchlog_submit(&record);
+}
+
+// 판마다 틱 구간 요약을 로그로 남김 (틱 스레드에서 game_mutex 를 놓은 뒤 호출)
+// 히스토그램은 틱 스레드만 갱신하므로 락 없이 읽어도 됨
+static void log_profile(void) {
+    char* text = NULL;
+    size_t size = 0;
+    FILE* out = open_memstream(&text, &size);
+    if (out == NULL) return;
+    prof_dump(out);
+    fclose(out);
+
+    char* save = NULL;
+    for (char* line = strtok_r(text, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save)) {
+        log_info("%s", line);
+    }
+    free(text);
+}
+
+// 화살/레드존 풀 사용량 기록 (game_mutex 보유 상태)
+static void record_pools(void) {
+    int arrows = 0, redzones = 0;
+    for (int i = 0; i < MAX_ARROWS; i++) arrows += state.arrow[i].active != 0;
+    for (int i = 0; i < MAX_REDZONES; i++) redzones += state.redzone[i].active != 0;
+    metrics.arrows_active = arrows;
+    metrics.redzones_active = redzones;
+}
+
+// 연결별 지표 (메트릭 스레드에서 호출)
+static void write_server_metrics(FILE* out) {
+    fprintf(out, "# HELP spacewar_send_queue_bytes Unsent bytes in the socket send buffer.\n");
+    fprintf(out, "# TYPE spacewar_send_queue_bytes gauge\n");
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        int sock = client_socket[i];
+        int pending = 0;
+        if (sock > 0 && ioctl(sock, SIOCOUTQ, &pending) == 0) {
+            fprintf(out, "spacewar_send_queue_bytes{player=\"%d\"} %d\n", i, pending);
+        }
+    }
+    fprintf(out, "# HELP spacewar_input_queue_depth Inputs waiting for the next tick.\n");
+    fprintf(out, "# TYPE spacewar_input_queue_depth gauge\n");
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        fprintf(out, "spacewar_input_queue_depth{player=\"%d\"} %u\n", i, ring_count(&input_queue[i]));
+    }
+
+    // 랙 보정 값은 틱 스레드가 game_mutex 안에서 바꾸므로 복사만 잠근 채로 하고 출력은 놓은 뒤에 함
+    int rewind[MAX_PLAYERS];
+    long long checks, rewinds, rewind_ticks, forgiven, late_hits, check_ns;
+    pthread_mutex_lock(&game_mutex);
+    for (int i = 0; i < MAX_PLAYERS; i++) rewind[i] = lagcomp_rewind(&lagcomp, i);
+    checks = lagcomp.checks;
+    rewinds = lagcomp.rewinds;
+    rewind_ticks = lagcomp.rewind_ticks;
+    forgiven = lagcomp.forgiven;
+    late_hits = lagcomp.late_hits;
+    check_ns = lagcomp.check_ns;
+    pthread_mutex_unlock(&game_mutex);
+
+    fprintf(out, "# HELP spacewar_lagcomp_rewind_ticks Ticks the player's hit tests are rewound by.\n");
+    fprintf(out, "# TYPE spacewar_lagcomp_rewind_ticks gauge\n");
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        fprintf(out, "spacewar_lagcomp_rewind_ticks{player=\"%d\"} %d\n", i, rewind[i]);
+    }
+    fprintf(out, "# HELP spacewar_lagcomp_checks_total Player hit tests run by lag compensation.\n");
+    fprintf(out, "# TYPE spacewar_lagcomp_checks_total counter\n");
+    fprintf(out, "spacewar_lagcomp_checks_total %lld\n", checks);
+    fprintf(out, "# HELP spacewar_lagcomp_rewinds_total Player hit tests resolved against a past tick.\n");
+    fprintf(out, "# TYPE spacewar_lagcomp_rewinds_total counter\n");
+    fprintf(out, "spacewar_lagcomp_rewinds_total %lld\n", rewinds);
+    fprintf(out, "# HELP spacewar_lagcomp_rewound_ticks_total Ticks rewound over all rewound hit tests.\n");
+    fprintf(out, "# TYPE spacewar_lagcomp_rewound_ticks_total counter\n");
+    fprintf(out, "spacewar_lagcomp_rewound_ticks_total %lld\n", rewind_ticks);
+    fprintf(out, "# HELP spacewar_lagcomp_outcome_changes_total Hit tests whose result differs from the unrewound test.\n");
+    fprintf(out, "# TYPE spacewar_lagcomp_outcome_changes_total counter\n");
+    fprintf(out, "spacewar_lagcomp_outcome_changes_total{result=\"forgiven\"} %lld\n", forgiven);
+    fprintf(out, "spacewar_lagcomp_outcome_changes_total{result=\"late_hit\"} %lld\n", late_hits);
+    fprintf(out, "# HELP spacewar_lagcomp_seconds_total Time spent in lag-compensated hit tests.\n");
+    fprintf(out, "# TYPE spacewar_lagcomp_seconds_total counter\n");
+    fprintf(out, "spacewar_lagcomp_seconds_total %.9f\n", check_ns / 1e9);
+    fprintf(out, "# HELP spacewar_matchlog_records_total Match records by outcome.\n");
+    fprintf(out, "# TYPE spacewar_matchlog_records_total counter\n");
+    fprintf(out, "spacewar_matchlog_records_total{result=\"written\"} %lld\n",
+            (long long)atomic_load_explicit(&matchlog_stats.written, memory_order_relaxed));
+    fprintf(out, "spacewar_matchlog_records_total{result=\"dropped\"} %lld\n",
+            (long long)atomic_load_explicit(&matchlog_stats.dropped, memory_order_relaxed));
+    fprintf(out, "spacewar_matchlog_records_total{result=\"failed\"} %lld\n",
+            (long long)atomic_load_explicit(&matchlog_stats.failed, memory_order_relaxed));
+    fprintf(out, "# HELP spacewar_matchlog_queue_depth Match records waiting for the writer thread.\n");
+    fprintf(out, "# TYPE spacewar_matchlog_queue_depth gauge\n");
+    fprintf(out, "spacewar_matchlog_queue_depth %u\n", matchlog_pending());
+    fprintf(out, "# HELP spacewar_matchlog_fsync_seconds_total Time the writer thread spent in fdatasync.\n");
+    fprintf(out, "# TYPE spacewar_matchlog_fsync_seconds_total counter\n");
+    fprintf(out, "spacewar_matchlog_fsync_seconds_total %.9f\n",
+            atomic_load_explicit(&matchlog_stats.sync_ns, memory_order_relaxed) / 1e9);
+    fprintf(out, "# HELP spacewar_matchlog_fsyncs_total Batched fdatasync calls on the match log.\n");
+    fprintf(out, "# TYPE spacewar_matchlog_fsyncs_total counter\n");
+    fprintf(out, "spacewar_matchlog_fsyncs_total %lld\n",
+            (long long)atomic_load_explicit(&matchlog_stats.syncs, memory_order_relaxed));
+    fprintf(out, "# HELP spacewar_log_lines_total Log lines that passed the level and rate checks.\n");
+    fprintf(out, "# TYPE spacewar_log_lines_total counter\n");
+    for (int i = 0; i < LOG_LEVELS; i++) {
+        fprintf(out, "spacewar_log_lines_total{level=\"%s\"} %lld\n",
+                log_level_name(i), (long long)atomic_load(&log_stats.records[i]));
+    }
+    fprintf(out, "# HELP spacewar_log_dropped_total Log lines lost because a thread's log ring was full.\n");
+    fprintf(out, "# TYPE spacewar_log_dropped_total counter\n");
+    fprintf(out, "spacewar_log_dropped_total %lld\n", (long long)atomic_load(&log_stats.dropped));
+    fprintf(out, "# HELP spacewar_log_rate_limited_total Log lines skipped by the per-site rate limit.\n");
+    fprintf(out, "# TYPE spacewar_log_rate_limited_total counter\n");
+    fprintf(out, "spacewar_log_rate_limited_total %lld\n", (long long)atomic_load(&log_stats.suppressed));
+    fprintf(out, "# HELP spacewar_log_level Current minimum log level (0 debug, 1 info, 2 warn, 3 error).\n");
+    fprintf(out, "# TYPE spacewar_log_level gauge\n");
+    fprintf(out, "spacewar_log_level %d\n", atomic_load(&log_level));
+}
+
 // 연결 상태 브로드캐스트
 void send_connection_status() {
     for (int i = 0; i < MAX_PLAYERS; i++) {
         if (state.player[i].connected) {
             Packet packet;
+            memset(&packet, 0, sizeof(packet));
             packet.type = PLAYER_STATUS;
             packet.id = i;
             memcpy(&packet.player, &state.player[i], sizeof(Player));
@@ -70,14 +364,24 @@ void* game_loop(void* arg) {
     int start = 0;//게임 시작햇는지
     
     time_t connect_wait_time = 0;
+    trace_thread("tick");
+    log_thread("tick");
     
     while (game_running) {
+        long long tick_start = now_ns();
+        long long trace_tick = trace_begin();
         pthread_mutex_lock(&game_mutex);
+        int timed = start;  // 대기/카운트다운이 끼지 않은 틱만 측정
+        if (timed) {
+            prof_end(PROF_LOCK_WAIT, tick_start);
+            trace_end("lock_wait", trace_tick, 0);
+        }
         
         // 연결된 플레이어 수 확인
         int connected = 0;
         if(state.player[0].connected)connected++;
         if(state.player[1].connected)connected++;
+        metrics.connected = connected;
         
         // --- 게임 종료 조건 확인 ---
         int winner = -1;
@@ -85,7 +389,7 @@ void* game_loop(void* arg) {
         
         if (start && connected < 2) {
             // 1. 게임 중에 한 명이 나간 경우
-            printf("플레이어 연결 끊김으로 게임 종료.\n");
+            log_info("플레이어 연결 끊김으로 게임 종료");
             
             if(state.player[0].connected)winner=0;
             else if (state.player[1].connected)winner=1;
@@ -106,21 +410,47 @@ void* game_loop(void* arg) {
         }
         // --- 게임 종료 처리 ---
         if (game_over) {
-            if (winner >= 0) printf("게임 종료! 플레이어 %d 승리!\n", winner);
+            if (winner >= 0) log_info("게임 종료! 플레이어 %d 승리 (프레임 %d)", winner, state.frame);
+            if (start && lagcomp.max_ticks > 0 && !lockstep_mode) {
+                char report[LOG_MSG_SIZE];
+                lagcomp_report(&lagcomp, report, sizeof(report));
+                log_info("%s", report);
+            }
+            if (start) match_end(winner, connected < 2);
 
-            Packet packet;
-            packet.type = GAME_OVER;
-            packet.id = winner;
-            send_packet(&packet);
+            if (lockstep_mode && start) {
+                // 락스텝 중에는 입력 프레임 형식으로 종료 알림
+                LockstepInput end;
+                memset(&end, 0, sizeof(end));
+                end.frame = state.frame;
+                end.id = (winner >= 0) ? (uint8_t)winner : LOCKSTEP_END;
+                end.item = LOCKSTEP_END;
+                relay_lockstep(&end, -1);
+            } else {
+                Packet packet;
+                memset(&packet, 0, sizeof(packet));
+                packet.type = GAME_OVER;
+                packet.id = winner;
+                send_packet(&packet);
+            }
             
-            alarm(0);
             pthread_mutex_unlock(&game_mutex);
-            
+
+            // 구간 요약 정렬과 트레이스 파일 쓰기는 락 밖에서 (연결 스레드가 기다리지 않도록)
+            if (start && prof_enabled) log_profile();
+            if (start) trace_flush();
             sleep(5); // 클라이언트가 결과 확인하고 재시작할 시간
             
             pthread_mutex_lock(&game_mutex);
             init_game(&state, true);
+            state.lockstep = lockstep_mode;
+            state.config.tick_hz = tick_hz;
+            lagcomp_reset(&lagcomp);
+            for (int i = 0; i < MAX_PLAYERS; i++) {
+                ring_clear(&input_queue[i]); // 지난 게임 입력 버림
+            }
             start = 0;
+            metrics.matches_active = 0;
             connect_wait_time = 0;
             pthread_mutex_unlock(&game_mutex);
             continue;
@@ -144,7 +474,7 @@ void* game_loop(void* arg) {
 
         if (connect_wait_time == 0) {
             connect_wait_time = time(NULL);
-            printf("2명 접속 완료! 5초 후 게임 시작...\n");
+            log_info("2명 접속 완료! 5초 후 게임 시작");
         }
 
         // 5초 대기 (조건 변수 타임아웃 사용)
@@ -152,9 +482,11 @@ void* game_loop(void* arg) {
         ts.tv_sec = connect_wait_time + 5;
         ts.tv_nsec = 0;
         
+        // time() 은 거친 시계라 대기가 끝난 직후에도 이전 초를 돌려줄 수 있으므로 시간 초과면 바로 나감
+        // (그대로 돌면 연결 상태를 수천 번 보내 송신 버퍼를 채움)
         while (time(NULL) - connect_wait_time < 5 && game_running) {
             send_connection_status();
-            pthread_cond_timedwait(&game_cond, &game_mutex, &ts);
+            if (pthread_cond_timedwait(&game_cond, &game_mutex, &ts) == ETIMEDOUT) break;
         }
         
         if (!game_running) {
@@ -164,63 +496,90 @@ void* game_loop(void* arg) {
 
         // --- 게임 시작 ---
         if (!start) {
-            signal(SIGALRM, event);
-            alarm(10);
             start = 1;
+            metrics.matches_active = 1;
+            metrics.matches_total++;
             state.frame = 0; // 게임 시작 시 프레임 초기화
-            printf("게임 로직 및 알람 시작!\n");
+            match_begin();
+
+            if (lockstep_mode) {
+                // 시드와 설정을 합의하고 이후에는 입력만 주고받음
+                seed_game(&state, (unsigned int)time(NULL));
+                lockstep_init(&lockstep, LOCKSTEP_DELAY);
+
+                Packet packet;
+                memset(&packet, 0, sizeof(packet));
+                packet.type = LOCKSTEP_START;
+                packet.frame = 0;
+                memcpy(&packet.game_state, &state, sizeof(GameState));
+                send_packet(&packet);
+            }
+            log_info("게임 로직 시작 (%dHz%s)", tick_hz, lockstep_mode ? ", lockstep" : "");
         }
-        
-        // --- 게임 진행 로직 ---
-        update_game(&state, GAME_WIDTH, GAME_HEIGHT);
-        
-        // 5초마다 플레이어 공격
-        if (start && state.frame > 0 && state.frame % 100 == 0) {
-            for (int i = 0; i < MAX_PLAYERS; i++) {
-                if (state.player[i].connected && state.player[i].lives > 0) {
-                    create_player_attack(&state, i);
-                }
+
+        long long t = prof_begin();
+        long long tt = trace_begin();
+        drain_inputs();
+        prof_end(PROF_INPUT, t);
+        trace_end("drain_inputs", tt, state.frame);
+
+        if (lockstep_mode) {
+            // 서버도 같은 입력으로 따라가며 승패만 판정
+            while (lockstep_ready(&lockstep, &state)) {
+                lockstep_advance(&lockstep, &state);
+            }
+            pthread_mutex_unlock(&game_mutex);
+            if (timed) {
+                long long elapsed = now_ns() - tick_start;
+                prof_end(PROF_TICK, tick_start);
+                metrics_tick(elapsed);
+                match_tick(elapsed);
+                trace_end("tick", trace_tick, state.frame);
             }
+            prof_poll();
+            trace_poll();
+            usleep(tick_usec);
+            continue;
         }
         
-        // 특수 웨이브 트리거 처리
-        if (special_wave) {
-            state.special_wave = 60;
-            special_wave = 0;
-            alarm(10);
-        }
+        // --- 게임 진행 로직 ---
+        tt = trace_begin();
+        update_game(&state, GAME_WIDTH, GAME_HEIGHT);
+        trace_end("update_game", tt, state.frame);
         
-        // 레드존 생성
-        if (redzone) {
-            redZone(&state, GAME_WIDTH, GAME_HEIGHT);
-            redzone = 0;
-        }
+        // 특수 웨이브, 레드존, 5초마다 플레이어 공격
+        tt = trace_begin();
+        update_events(&state, GAME_WIDTH, GAME_HEIGHT);
+        trace_end("update_events", tt, state.frame);
         
-        // 게임 상태 전송 (화살,레드존 플레이어)
+        // 게임 상태 전송 (화살, 레드존, 플레이어를 한 틱 단위로)
+        // 클라이언트는 이 프레임을 기준으로 되감기/재시뮬레이션함
+        t = prof_begin();
         Packet packet;
-        packet.type = ARROW_UPDATE;
-        memcpy(packet.arrows, state.arrow, sizeof(state.arrow));
-        send_packet(&packet);
-        
-        packet.type = REDZONE_UPDATE;
-        memcpy(packet.redzones, state.redzone, sizeof(state.redzone));
+        memset(&packet, 0, sizeof(packet));
+        packet.type = STATE_UPDATE;
+        packet.frame = state.frame;
+        memcpy(&packet.game_state, &state, sizeof(GameState));
+        prof_end(PROF_SERIALIZE, t);
+
+        if (metrics_enabled) record_pools();
+
+        t = prof_begin();
+        packet.sent_ns = now_ns();
         send_packet(&packet);
-        
-        if (state.player[0].connected) {
-            packet.type = PLAYER_STATUS;
-            packet.id = 0;
-            memcpy(&packet.player, &state.player[0], sizeof(Player));
-            send_packet(&packet);
-        }
-        if (state.player[1].connected) {
-            packet.type = PLAYER_STATUS;
-            packet.id = 1;
-            memcpy(&packet.player, &state.player[1], sizeof(Player));
-            send_packet(&packet);
-        }
+        prof_end(PROF_SEND, t);
             
         pthread_mutex_unlock(&game_mutex);
-        usleep(50000);
+        if (timed) {
+            long long elapsed = now_ns() - tick_start;
+            prof_end(PROF_TICK, tick_start);
+            metrics_tick(elapsed);
+            match_tick(elapsed);
+            trace_end("tick", trace_tick, state.frame);
+        }
+        prof_poll();
+        trace_poll();
+        usleep(tick_usec);
     }
     
     return NULL;
@@ -231,6 +590,8 @@ void* client_handler(void* arg) {
     int client_sock = *(int*)arg;
     free(arg);
     int id = -1;
+    trace_thread("conn");
+    log_thread("conn");
     
     pthread_mutex_lock(&game_mutex);
     for (int i = 0; i < MAX_PLAYERS; i++) {
@@ -238,87 +599,206 @@ void* client_handler(void* arg) {
             id = i;
             state.player[i].connected = 1;
             client_socket[i] = client_sock;
+            send_failed[i] = 0;
+            ring_clear(&input_queue[i]); // 이전 연결이 남긴 입력 버림
             break;
         }
     }
+    if (id != -1) {
+        // 초기 상태 전송: client_socket[id] 가 공개된 뒤이므로 잠근 채로 보내야 틱 스레드의 패킷과
+        // 섞이지 않음 (송신 제한으로 부분 전송된 뒤 다른 패킷이 끼어들 수 있음)
+        Packet packet;
+        memset(&packet, 0, sizeof(packet));
+        packet.type = INITIAL_STATE;
+        packet.id = id;
+        memcpy(&packet.game_state, &state, sizeof(GameState));
+        if (net_write_full(client_sock, &packet, sizeof(Packet)) == 0) {
+            metrics_packet_out(INITIAL_STATE, sizeof(Packet));
+        } else {
+            drop_client(id);
+        }
+
+        // 연결 상태 즉시 전송
+        send_connection_status();
+    }
     pthread_cond_signal(&game_cond);  // 플레이어 접속 알림
     pthread_mutex_unlock(&game_mutex);
     
     if (id == -1) {
-        printf("서버 가득참\n");
+        log_warn("서버 가득참, 연결 거절");
         close(client_sock);
         return NULL;
     }
     
-    printf("플레이어 %d 연결됨\n", id);
-    
-    // 초기 상태 전송
-    pthread_mutex_lock(&game_mutex);
-    Packet packet;
-    packet.type = INITIAL_STATE;
-    packet.id = id;
-    memcpy(&packet.game_state, &state, sizeof(GameState));
-    pthread_mutex_unlock(&game_mutex);
-    
-    write(client_sock, &packet, sizeof(Packet));
-    
-    // 연결 상태 즉시 전송
-    pthread_mutex_lock(&game_mutex);
-    send_connection_status();
-    pthread_mutex_unlock(&game_mutex);
+    log_info("플레이어 %d 연결됨", id);
     
+    // 수신한 입력은 큐에 넣기만 하고 game_mutex 는 잡지 않음
+    // 소켓에 NET_IDLE_TIMEOUT_MS 수신 제한이 걸려 있어 하트비트가 끊기면 읽기가 실패함
+    long long last_recv = now_ns();
+    int read_errno = 0;
     while (game_running) {
-        Packet recv_packet;
-        int recv_size = read(client_sock, &recv_packet, sizeof(Packet));
-        
-        if (recv_size <= 0) {
-            break;
-        }
-        
-        pthread_mutex_lock(&game_mutex);
-        
-        switch (recv_packet.type) {
-            case PLAYER_MOVE:
-                state.player[id].x = recv_packet.x;
-                state.player[id].y = recv_packet.y;
+        InputEvent ev;
+        memset(&ev, 0, sizeof(ev));
+
+        errno = 0;
+        if (lockstep_mode) {
+            if (lockstep_recv(client_sock, &ev.lockstep) != 0) {
+                read_errno = errno;
                 break;
-                
-            case ITEM_USE:
-                switch (recv_packet.item_type) {
-                    case 1: invincible_item(&state.player[id]); break;
-                    case 2: heal_item(&state.player[id]); break;
-                    case 3: slow_item(&state.player[id]); break;
-                }
+            }
+            last_recv = now_ns();
+            ev.lockstep.id = (uint8_t)id; // 다른 플레이어 입력 위조 방지
+            metrics_packet_in(METRICS_LOCKSTEP, sizeof(LockstepInput));
+            trace_instant(packet_name(METRICS_LOCKSTEP), ev.lockstep.frame);
+            if (ev.lockstep.item == LOCKSTEP_HEARTBEAT) {
+                continue;
+            }
+        } else {
+            Packet recv_packet;
+            if (net_read_full(client_sock, &recv_packet, sizeof(Packet)) != 0) {
+                read_errno = errno;
                 break;
-            default: break;
+            }
+            last_recv = now_ns();
+            metrics_packet_in(recv_packet.type, sizeof(Packet));
+            trace_instant(packet_name(recv_packet.type), recv_packet.frame);
+            if (recv_packet.type != PLAYER_MOVE && recv_packet.type != ITEM_USE) {
+                continue;
+            }
+            ev.type = recv_packet.type;
+            ev.x = recv_packet.x;
+            ev.y = recv_packet.y;
+            ev.item_type = recv_packet.item_type;
+            ev.frame = recv_packet.frame;
+            ev.view_frame = recv_packet.view_frame;
+            if (recv_packet.input_id != 0) {
+                ev.trace.input_id = recv_packet.input_id;
+                ev.trace.sent_ns = recv_packet.sent_ns;
+                ev.trace.recv_ns = now_ns();
+            }
+        }
+
+        if (ring_push(&input_queue[id], &ev) != 0) {
+            long long drops = atomic_fetch_add_explicit(&input_drops[id], 1, memory_order_relaxed) + 1;
+            log_warn("플레이어 %d 입력 큐 가득참, 입력 버림 (누적 %lld)", id, drops);
+            if (metrics_enabled) metrics.input_drops++;
         }
-        pthread_mutex_unlock(&game_mutex);
     }
     
+    DisconnectReason reason = DISCONNECT_CLOSED;
+    if (send_failed[id]) reason = DISCONNECT_SEND;
+    else if (read_errno == EAGAIN || read_errno == EWOULDBLOCK) reason = DISCONNECT_IDLE;
+    else if (read_errno == ETIMEDOUT) reason = DISCONNECT_KEEPALIVE;
+
     pthread_mutex_lock(&game_mutex);
     state.player[id].connected = 0;
     client_socket[id] = 0;
     pthread_cond_signal(&game_cond);  // 플레이어 연결 해제 알림
     pthread_mutex_unlock(&game_mutex);
-    
-    printf("플레이어 %d 연결 해제\n", id);
+
+    long long silent_ns = now_ns() - last_recv;
+    long long drops = atomic_load_explicit(&input_drops[id], memory_order_relaxed);
+    metrics_disconnect(reason, silent_ns);
+    if (reason == DISCONNECT_CLOSED) {
+        log_info("플레이어 %d 연결 해제 (%s, 마지막 수신 후 %lldms, 버린 입력 %lld)",
+                 id, disconnect_name(reason), silent_ns / 1000000, drops);
+    } else {
+        log_warn("플레이어 %d 연결 해제 (%s, 마지막 수신 후 %lldms, 버린 입력 %lld)",
+                 id, disconnect_name(reason), silent_ns / 1000000, drops);
+    }
     close(client_sock);
     return NULL;
 }
 
-int main() {
+// 시작 실패: 런처가 기다리고 있으면 이유를 알리고 종료
+static void startup_failed(const char* what) {
+    char reason[200];
+    snprintf(reason, sizeof(reason), "%s: %s", what, strerror(errno));
+    log_error("%s", reason);
+    net_notify_ready(reason);
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
     int server_sock, client_sock;
     struct sockaddr_in server_addr, client_addr;
     socklen_t client_addr_size;
     pthread_t game_thread;
+    int metrics_port = 0;
+    const char* match_log = MATCHLOG_DEFAULT_PATH;
+    const char* log_level_arg = NULL;
     
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--lockstep") == 0) lockstep_mode = 1;
+        else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) metrics_port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--lag-comp-ms") == 0 && i + 1 < argc) lag_comp_ms = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--match-log") == 0 && i + 1 < argc) match_log = argv[++i];
+        else if (strcmp(argv[i], "--no-match-log") == 0) match_log = NULL;
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) log_level_arg = argv[++i];
+        else if (strcmp(argv[i], "--show-matches") == 0) {
+            // 판 기록만 출력하고 종료 (경로를 생략하면 기본 경로)
+            const char* path = (i + 1 < argc) ? argv[i + 1] : MATCHLOG_DEFAULT_PATH;
+            if (matchlog_dump(path, stdout) == 0) printf("판 기록 없음: %s\n", path);
+            return 0;
+        }
+        else if (strcmp(argv[i], "--tick-hz") == 0 && i + 1 < argc) {
+            int hz = atoi(argv[++i]);
+            if (hz > 0 && hz <= 1000) {
+                tick_hz = hz;
+                tick_usec = 1000000 / hz;
+            }
+        }
+    }
+
+    // 로그는 스레드별 링에 넣고 기록 스레드가 씀 (SPACEWAR_LOG=<경로 접두사> 면 파일, kill -RTMIN 으로 debug 전환)
+    log_init_env("server");
+    log_thread("accept");
+    log_toggle_signal(SIGRTMIN);   // SIGHUP 은 터미널이 닫힐 때 서버를 끝내야 하므로 쓰지 않음
+    if (log_level_arg != NULL) {
+        if (log_parse_level(log_level_arg) < 0) {
+            fprintf(stderr, "알 수 없는 로그 수준: %s (debug|info|warn|error)\n", log_level_arg);
+            return 1;
+        }
+        log_set_level(log_parse_level(log_level_arg));
+    }
+
+    // SPACEWAR_PROFILE=<초> 면 틱 구간별 소요 시간 출력 (0 이면 kill -USR1 때만)
+    prof_init_env(tick_usec * 1000LL, stdout);
+    // SPACEWAR_TRACE=<경로 접두사> 면 판이 끝날 때와 kill -USR2 때 Chrome trace 기록
+    trace_init_env("server");
+    trace_thread("accept");
+
+    // --metrics-port <포트>: 127.0.0.1 에서 Prometheus 텍스트 지표 제공
+    if (metrics_port > 0) {
+        if (metrics_start(metrics_port, tick_usec * 1000LL, write_server_metrics) != 0) {
+            startup_failed("메트릭 포트 열기 실패");
+        }
+        log_info("메트릭 http://127.0.0.1:%d/metrics", metrics_port);
+    }
+
+    // 판이 끝날 때마다 요약을 기록 스레드가 <match_log> 에 붙임 (틱 스레드는 디스크를 기다리지 않음)
+    if (match_log != NULL && matchlog_start(match_log) != 0) {
+        log_warn("판 기록 파일 열기 실패: %s: %s (기록 없이 계속)", match_log, strerror(errno));
+    }
+
     srand(time(NULL));
     init_game(&state, true);
+    state.lockstep = lockstep_mode;
+    state.config.tick_hz = tick_hz;
+
+    // 락스텝은 모든 클라이언트가 같은 규칙으로 시뮬레이션해야 하므로 랙 보정 없음
+    lagcomp_init(&lagcomp, lockstep_mode ? 0 : lag_comp_ms, tick_hz);
+    if (lagcomp.max_ticks > 0) set_collision_handler(lag_compensated_collisions);
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (ring_init(&input_queue[i], sizeof(InputEvent), INPUT_QUEUE_SIZE) != 0) {
+            startup_failed("입력 큐 생성 실패");
+        }
+    }
     
     server_sock = socket(AF_INET, SOCK_STREAM, 0);
     if (server_sock == -1) {
-        perror("소켓 생성 실패");
-        exit(1);
+        startup_failed("소켓 생성 실패");
     }
     
     int opt = 1;
@@ -330,16 +810,15 @@ int main() {
     server_addr.sin_port = htons(PORT);
     
     if (bind(server_sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) == -1) {
-        perror("바인드 실패");
-        exit(1);
+        startup_failed("바인드 실패");
     }
     
     if (listen(server_sock, 5) == -1) {
-        perror("리슨 실패");
-        exit(1);
+        startup_failed("리슨 실패");
     }
     
-    printf("서버 시작 포트 %d\n", PORT);
+    log_info("서버 시작 포트 %d%s", PORT, lockstep_mode ? " (lockstep)" : "");
+    net_notify_ready(NULL);     // 런처는 sleep 대신 이 알림을 기다림
     
     pthread_create(&game_thread, NULL, game_loop, NULL);
     
@@ -348,10 +827,22 @@ int main() {
         client_sock = accept(server_sock, (struct sockaddr*)&client_addr, &client_addr_size);
         
         if (client_sock == -1) {
-            perror("연결 수락 실패");
+            log_error("연결 수락 실패: %s", strerror(errno));
             continue;
         }
         
+        // 틱마다 보내는 상태가 Nagle 에 묶여 지연 ACK 만큼 늦어지지 않도록
+        int nodelay = 1;
+        setsockopt(client_sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        // 반쯤 열린 연결이 자리를 붙잡지 않도록 몇 초 안에 죽은 상대를 감지
+        net_keepalive(client_sock, NET_IDLE_TIMEOUT_MS);
+        // 전송은 game_mutex 를 쥔 틱 스레드가 하므로 몇 ms 만 기다림
+        // 대신 송신 버퍼를 NET_IDLE_TIMEOUT_MS 동안의 상태 패킷만큼 잡아 잠깐 멈춘 상대는 끊지 않음
+        net_io_timeout(client_sock, NET_IDLE_TIMEOUT_MS, NET_SEND_TIMEOUT_MS);
+        int sndbuf = (int)(tick_hz * sizeof(Packet) * NET_IDLE_TIMEOUT_MS / 1000);
+        setsockopt(client_sock, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
         int* client_sock_ptr = malloc(sizeof(int));
         *client_sock_ptr = client_sock;
         
@@ -367,7 +858,7 @@ int main() {
         if (slot != -1) {
             pthread_create(&client_threads[slot], NULL, client_handler, client_sock_ptr);
         } else {
-            printf("서버 가득참\n");
+            log_warn("서버 가득참, 연결 거절");
             free(client_sock_ptr);
             close(client_sock);
         }
@@ -379,6 +870,7 @@ int main() {
 
     
     pthread_join(game_thread, NULL);
+    matchlog_stop();
     close(server_sock);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include <curses.h>
+#include <stdlib.h>
+#include "single_game.h"
+#include "game_logic.h"
+#include "view.h"
+#include "item.h"
+#include "common.h"
+#include "profile.h"
+#include "input.h"
+#include "timeutil.h"
+
+static GameState state;
+static InputQueue keys;     // 틱 사이에 들어온 키 (도착 순서대로 모두 적용)
+
+void single_game_run(SingleResult* result) {
+    int id = 0;
+    int quit = 0;
+
+    view_setup();
+    init_game(&state, false);
+    long long tick_ns = config_tick_ns(&state.config);
+
+    // 화면을 쓰고 있으므로 프로파일 결과는 파일로 출력
+    FILE* prof_log = NULL;
+    if (getenv("SPACEWAR_PROFILE") != NULL) {
+        prof_log = fopen("single_profile.log", "a");
+        if (prof_log != NULL) prof_init_env(tick_ns, prof_log);
+    }
+
+    input_init(&keys);
+    long long next_tick = now_ns();
+
+    //게임 루프
+    while (state.player[id].lives > 0) {  // status 제거
+
+        // 다음 틱까지 키가 들어오는 대로 읽어 둠
+        long long wait;
+        while ((wait = next_tick - now_ns()) > 0) {
+            if (input_wait(wait / 1000)) input_drain(&keys);
+        }
+        input_drain(&keys);
+
+        // 고정 간격 유지 (한 틱 넘게 밀렸으면 다시 맞춤)
+        next_tick += tick_ns;
+        if (now_ns() - next_tick > tick_ns) next_tick = now_ns() + tick_ns;
+
+        long long tick_start = prof_begin();
+        KeyEvent ev;
+        while (input_pop(&keys, &ev) == 0) {
+            switch(ev.key) {
+
+                case KEY_LEFT: 
+                    move_player(&state.player[id], -1, 0);
+                    break;  // 밖으로 이동
+                
+                case KEY_RIGHT: 
+                    move_player(&state.player[id], 1, 0);
+                    break;
+                
+                case KEY_UP:    
+                    move_player(&state.player[id], 0, -1);
+                    break;
+                
+                case KEY_DOWN:  
+                    move_player(&state.player[id], 0, 1);
+                    break;
+                
+                case '1': 
+                    invincible_item(&state.player[id], &state.config); 
+                    break;
+                
+                case '2': 
+                    heal_item(&state.player[id]); 
+                    break;
+                
+                case '3': 
+                    slow_item(&state.player[id], &state.config); 
+                    break;
+                
+                case 'q': 
+                case 'Q':
+                    state.player[id].lives = 0;  
+                    quit = 1;
+                    break;
+            }
+        }
+        prof_end(PROF_INPUT, tick_start);
+
+        update_game(&state, GAME_WIDTH, GAME_HEIGHT);
+        update_events(&state, GAME_WIDTH, GAME_HEIGHT);
+
+        // 터미널 출력 예산을 넘어 품질을 낮췄으면 틱마다 그리지 않음
+        long long t = prof_begin();
+        if (view_frame_interval_us(tick_ns / 1000, tick_ns) <= tick_ns / 1000 || state.frame % 2 == 0) {
+            draw_game(&state, id, state.frame);
+            view_present();
+            input_shown(&keys, now_ns());
+        }
+        prof_end(PROF_RENDER, t);
+
+        prof_end(PROF_TICK, tick_start);
+        prof_poll();
+    }
+
+    // Game Over
+    int level = game_level(&state);
+    singleGameOverScreen(state.player[id].score, level);
+
+    if (prof_log != NULL) {
+        prof_dump(prof_log);
+        prof_enabled = 0;
+        fclose(prof_log);
+    }
+
+    result->score = state.player[id].score;
+    result->level = level;
+    result->frames = state.frame;
+    result->quit = quit;
+}
+
+void single_game_report(FILE* out) {
+    input_report(&keys, "input", out);
+}
@@ -0,0 +1,38 @@
+#include "snapshot.h"
+#include <string.h>
+
+#define SNAPSHOT_FRESH 4u       // latest 에 아직 소비되지 않은 상태가 있음
+
+void snapshot_init(SnapshotBuffer* sb) {
+    memset(sb->buf, 0, sizeof(sb->buf));
+    sb->back = 0;
+    atomic_init(&sb->latest, 1);
+    sb->front = 2;
+    sb->published = 0;
+    sb->acquired = 0;
+}
+
+// 생산자가 다음 상태를 만들 버퍼
+GameState* snapshot_back(SnapshotBuffer* sb) {
+    return &sb->buf[sb->back];
+}
+
+// back 을 최신 상태로 발행하고 이전 최신 버퍼를 새 back 으로 받음
+void snapshot_publish(SnapshotBuffer* sb) {
+    unsigned int prev = atomic_exchange_explicit(&sb->latest, sb->back | SNAPSHOT_FRESH,
+                                                 memory_order_acq_rel);
+    sb->back = prev & ~SNAPSHOT_FRESH;
+    sb->published++;
+}
+
+// 새로 발행된 상태가 있으면 front 와 교체. 항상 읽기 일관된 front 를 돌려줌
+const GameState* snapshot_acquire(SnapshotBuffer* sb, int* fresh) {
+    *fresh = 0;
+    if (atomic_load_explicit(&sb->latest, memory_order_relaxed) & SNAPSHOT_FRESH) {
+        unsigned int prev = atomic_exchange_explicit(&sb->latest, sb->front, memory_order_acq_rel);
+        sb->front = prev & ~SNAPSHOT_FRESH;
+        sb->acquired++;
+        *fresh = 1;
+    }
+    return &sb->buf[sb->front];
+}
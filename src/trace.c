@@ -0,0 +1,174 @@
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// 스레드별 이벤트 링 (기록은 소유 스레드만, flush 는 다른 스레드에서 읽기만 함)
+typedef struct {
+    TraceEvent events[TRACE_EVENTS];
+    atomic_uint head;           // 지금까지 기록한 이벤트 수
+    const char* name;
+    int in_use;                 // 살아 있는 스레드가 쓰는 중
+} TraceBuffer;
+
+int trace_enabled = 0;
+
+static TraceBuffer* buffers[TRACE_MAX_THREADS];
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t buffer_key;
+static __thread TraceBuffer* local = NULL;
+static __thread int local_full = 0;     // 슬롯이 없어 기록하지 않는 스레드
+
+static const char* process_name = "";
+static char trace_path[256];
+static volatile sig_atomic_t flush_requested = 0;
+
+static void on_sigusr2(int sig) {
+    (void)sig;
+    flush_requested = 1;
+}
+
+// 스레드 종료 시 슬롯 반납 (이벤트는 다른 스레드가 재사용할 때까지 남음)
+static void release_buffer(void* arg) {
+    TraceBuffer* buffer = (TraceBuffer*)arg;
+    pthread_mutex_lock(&registry_mutex);
+    buffer->in_use = 0;
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+void trace_init_env(const char* process) {
+    const char* prefix = getenv("SPACEWAR_TRACE");
+    if (prefix == NULL || prefix[0] == '\0') return;
+
+    process_name = process;
+    snprintf(trace_path, sizeof(trace_path), "%s.%s.%d.json", prefix, process, (int)getpid());
+    pthread_key_create(&buffer_key, release_buffer);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigusr2;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR2, &sa, NULL);
+
+    trace_enabled = 1;
+}
+
+// 처음 쓰는 슬롯을 우선 사용하고, 없으면 종료된 스레드의 슬롯을 재사용
+static TraceBuffer* acquire_buffer(const char* name) {
+    TraceBuffer* found = NULL;
+
+    pthread_mutex_lock(&registry_mutex);
+    for (int i = 0; i < TRACE_MAX_THREADS && found == NULL; i++) {
+        if (buffers[i] == NULL) {
+            buffers[i] = calloc(1, sizeof(TraceBuffer));
+            found = buffers[i];
+        }
+    }
+    for (int i = 0; i < TRACE_MAX_THREADS && found == NULL; i++) {
+        if (!buffers[i]->in_use) {
+            found = buffers[i];
+            atomic_store(&found->head, 0);
+        }
+    }
+    if (found != NULL) {
+        found->name = name;
+        found->in_use = 1;
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    if (found != NULL) pthread_setspecific(buffer_key, found);
+    return found;
+}
+
+void trace_thread(const char* name) {
+    if (!trace_enabled) return;
+    if (local != NULL) {
+        local->name = name;
+        return;
+    }
+    local = acquire_buffer(name);
+    local_full = (local == NULL);
+}
+
+static void record(const char* name, char phase, long long ts, long long dur, int arg) {
+    if (local == NULL) {
+        if (local_full) return;
+        trace_thread("thread");
+        if (local == NULL) return;
+    }
+
+    unsigned int head = atomic_load_explicit(&local->head, memory_order_relaxed);
+    TraceEvent* ev = &local->events[head % TRACE_EVENTS];
+    ev->name = name;
+    ev->phase = phase;
+    ev->ts_ns = ts;
+    ev->dur_ns = dur;
+    ev->arg = arg;
+    atomic_store_explicit(&local->head, head + 1, memory_order_release);
+}
+
+void trace_end(const char* name, long long start, int arg) {
+    if (!trace_enabled) return;
+    record(name, 'X', start, realtime_ns() - start, arg);
+}
+
+void trace_instant(const char* name, int arg) {
+    if (!trace_enabled) return;
+    record(name, 'i', realtime_ns(), 0, arg);
+}
+
+// Chrome trace 의 ts/dur 는 마이크로초 (정밀도 유지를 위해 정수부/소수부 따로 출력)
+static void write_us(FILE* fp, long long ns) {
+    fprintf(fp, "%lld.%03lld", ns / 1000, ns % 1000);
+}
+
+int trace_flush(void) {
+    if (!trace_enabled) return -1;
+
+    FILE* fp = fopen(trace_path, "w");
+    if (fp == NULL) return -1;
+
+    int pid = (int)getpid();
+    fprintf(fp, "{\"traceEvents\":[\n");
+    fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}",
+            pid, process_name);
+
+    pthread_mutex_lock(&registry_mutex);
+    for (int t = 0; t < TRACE_MAX_THREADS && buffers[t] != NULL; t++) {
+        TraceBuffer* buffer = buffers[t];
+        fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                pid, t + 1, buffer->name);
+
+        // 기록 중인 스레드와 겹칠 수 있는 가장 오래된 구간은 건너뜀
+        unsigned int head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+        unsigned int count = head < TRACE_EVENTS ? head : TRACE_EVENTS - 64;
+        for (unsigned int i = head - count; i != head; i++) {
+            const TraceEvent* ev = &buffer->events[i % TRACE_EVENTS];
+            fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":",
+                    ev->name, ev->phase, pid, t + 1);
+            write_us(fp, ev->ts_ns);
+            if (ev->phase == 'X') {
+                fprintf(fp, ",\"dur\":");
+                write_us(fp, ev->dur_ns);
+            } else {
+                fprintf(fp, ",\"s\":\"t\"");
+            }
+            fprintf(fp, ",\"args\":{\"v\":%d}}", ev->arg);
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    return 0;
+}
+
+void trace_poll(void) {
+    if (!flush_requested) return;
+    flush_requested = 0;
+    trace_flush();
+}
@@ -1,10 +1,34 @@
 #include "view.h"
 #include "game_logic.h" 
+#include "timeutil.h"
 #include <unistd.h>    
 #include <string.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <termios.h>
+
+#define OUTPUT_WINDOW_NS 1000000000LL   // 출력량 평가 주기 (1초)
+#define DEFAULT_TTY_BUDGET 24000        // 기본 초당 출력 예산 (바이트)
+#define DRAIN_BUDGET_NS 8000000LL       // 프레임당 tty 비우기 허용 시간
+
+// 터미널 출력 측정 및 품질 단계 (그리는 스레드에서만 사용)
+static ViewOutput output;
+static int io_fd = -1;                  // /proc/thread-self/io (그리는 스레드에 묶임)
+static long long last_wchar = 0;
+static long long window_start = 0;
+static long long window_bytes = 0;
+static long long window_frames = 0;
+static long long window_drain_ns = 0;
+static int calm_windows = 0;            // 예산 안에서 연속으로 지난 주기 수
+static int show_output = 0;             // HUD 에 출력량 표시
 
 void view_init() {
     initscr();                  // ncurses 모드 시작
+    view_setup();
+}
+
+void view_setup(void) {
     raw();                      // 라인 버퍼링 비활성화 (Enter 없이 즉시 입력 받음, Ctrl+C 등 시그널 전달 안 함)
     noecho();                   // 입력한 키가 화면에 출력되지 않도록 설정
     curs_set(0);                // 커서(깜빡이는 밑줄)를 숨김
@@ -25,49 +49,214 @@ void view_init() {
         init_pair(7, COLOR_MAGENTA, -1);    // 7: 자홍
     }
     intrflush(stdscr, FALSE);   // 인터럽트 발생 시 출력 버퍼 비우기 방지 (화면 깨짐 방지)
+
+    // curses 는 tty 에 직접 write 하므로 이 스레드가 쓴 바이트 수(wchar)로 출력량을 잼
+    if (io_fd == -1) io_fd = open("/proc/thread-self/io", O_RDONLY);
+    const char* budget = getenv("SPACEWAR_TTY_BUDGET");
+    output.budget = budget ? atol(budget) : DEFAULT_TTY_BUDGET;
+    show_output = getenv("SPACEWAR_STATS") != NULL;
+
+    // 메뉴 화면 위에서 다시 시작할 수 있으므로 이전 판의 화면 내용은 믿지 않음
+    clear();
+    view_invalidate();
 }
 
+// 이 스레드가 지금까지 write 한 바이트 수
+static long long written_bytes(void) {
+    char buf[256];
+    if (io_fd < 0) return 0;
 
-void draw_game(const GameState* game_state, int id, int frame) {
-    erase(); // 그리기 전 화면 초기화
-    
-    // 특수 웨이브 경고 효과
-    // 10프레임 중 5프레임은 반전/굵게 표시하여 깜빡이는 효과를 줌
-    if (game_state->special_wave > 0 && (frame % 10 < 5)) {
-        attron(A_REVERSE | A_BOLD);
+    ssize_t n = pread(io_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+
+    const char* w = strstr(buf, "wchar:");
+    return w ? atoll(w + 6) : 0;
+}
+
+// 1초마다 출력량을 예산과 비교해 품질 단계를 올리거나 내림
+static void adapt_quality(long long now) {
+    long long elapsed = now - window_start;
+    if (elapsed < OUTPUT_WINDOW_NS) return;
+
+    output.bytes_per_sec = window_bytes * 1000000000LL / elapsed;
+    output.bytes_per_frame = window_frames ? window_bytes / window_frames : 0;
+    output.drain_us = window_frames ? window_drain_ns / window_frames / 1000 : 0;
+
+    int over = output.bytes_per_sec > output.budget ||
+               output.drain_us * 1000 > DRAIN_BUDGET_NS;
+    int under = output.bytes_per_sec < output.budget / 2 &&
+                output.drain_us * 1000 < DRAIN_BUDGET_NS / 2;
+
+    if (over && output.quality < VIEW_QUALITY_MIN) {
+        output.quality++;
+        output.degrades++;
+        calm_windows = 0;
+    } else if (under && output.quality > 0) {
+        // 바로 되돌리면 오르내림을 반복하므로 3초 연속 여유가 있을 때만 복구
+        if (++calm_windows >= 3) {
+            output.quality--;
+            calm_windows = 0;
+        }
+    } else {
+        calm_windows = 0;
+    }
+
+    window_start = now;
+    window_bytes = window_frames = window_drain_ns = 0;
+}
+
+// refresh 후 tty 가 출력을 다 내보낼 때까지 기다리며 출력량 측정
+void view_present(void) {
+    refresh();
+
+    long long start = now_ns();
+    tcdrain(STDOUT_FILENO);
+    long long now = now_ns();
+
+    long long wchar = written_bytes();
+    long long bytes = last_wchar ? wchar - last_wchar : 0;
+    last_wchar = wchar;
+
+    if (window_start == 0) window_start = now;
+    window_bytes += bytes;
+    window_frames++;
+    window_drain_ns += now - start;
+    output.total_bytes += bytes;
+    output.frames++;
+
+    adapt_quality(now);
+}
+
+const ViewOutput* view_output(void) {
+    return &output;
+}
+
+// 품질 단계에 맞는 최소 그리기 간격 (단계를 낮추면 틱마다, 더 낮추면 두 틱마다)
+long long view_frame_interval_us(long long base_us, long long tick_ns) {
+    long long tick_us = tick_ns / 1000;
+    if (output.quality >= VIEW_QUALITY_OUTLINE && base_us < 2 * tick_us) return 2 * tick_us;
+    if (output.quality >= VIEW_QUALITY_RATE && base_us < tick_us) return tick_us;
+    return base_us;
+}
+
+
+// 화면 셀 버퍼 (글자 + 속성 + 색상)
+// 매 프레임 next_cells 에 새로 그린 뒤 shown_cells(실제로 화면에 나간 내용)와 다른 셀만 출력함
+static chtype next_cells[GAME_HEIGHT][GAME_WIDTH];
+static chtype shown_cells[GAME_HEIGHT][GAME_WIDTH];
+static chtype border_cells[GAME_HEIGHT][GAME_WIDTH];   // 테두리만 그려진 정적 레이어
+static int border_ready = 0;
+static int shown_valid = 0;   // 0 이면 다음 프레임은 전체를 다시 출력
+
+// 다른 화면(대기/결과 등)을 그린 뒤에는 다음 draw_game 이 전체를 다시 그리도록 함
+void view_invalidate(void) {
+    shown_valid = 0;
+}
+
+static chtype color_attr(int pair) {
+    return has_colors() ? COLOR_PAIR(pair) : 0;
+}
+
+// ACS 문자는 initscr 이후에만 값이 정해지므로 처음 그릴 때 만듦
+static void build_border(void) {
+    for (int y = 0; y < GAME_HEIGHT; y++) {
+        for (int x = 0; x < GAME_WIDTH; x++) {
+            border_cells[y][x] = ' ';
+        }
+    }
+    for (int x = 1; x < GAME_WIDTH - 1; x++) {
+        border_cells[0][x] = ACS_HLINE;
+        border_cells[GAME_HEIGHT - 1][x] = ACS_HLINE;
+    }
+    for (int y = 1; y < GAME_HEIGHT - 1; y++) {
+        border_cells[y][0] = ACS_VLINE;
+        border_cells[y][GAME_WIDTH - 1] = ACS_VLINE;
+    }
+    border_cells[0][0] = ACS_ULCORNER;                                // 좌상단
+    border_cells[0][GAME_WIDTH - 1] = ACS_URCORNER;                   // 우상단
+    border_cells[GAME_HEIGHT - 1][0] = ACS_LLCORNER;                  // 좌하단
+    border_cells[GAME_HEIGHT - 1][GAME_WIDTH - 1] = ACS_LRCORNER;     // 우하단
+    border_ready = 1;
+}
+
+static void put_cell(int y, int x, chtype ch) {
+    if (y >= 0 && y < GAME_HEIGHT && x >= 0 && x < GAME_WIDTH) next_cells[y][x] = ch;
+}
+
+// 버퍼에 문자열 쓰기 (화면 폭에서 잘림), 쓴 다음 x 위치 반환
+static int put_text(int y, int x, chtype attr, const char* fmt, ...) {
+    char text[GAME_WIDTH + 1];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    for (const char* c = text; *c; c++, x++) {
+        put_cell(y, x, (chtype)(unsigned char)*c | attr);
     }
+    return x;
+}
+
+// 바뀐 셀만 출력 (같은 줄에서 연속된 셀은 커서 이동 없이 이어서 씀)
+static void flush_cells(void) {
+    if (!shown_valid) erase(); // 다른 화면이 남긴 내용 지움
+
+    for (int y = 0; y < GAME_HEIGHT; y++) {
+        int cursor = -1;
+        for (int x = 0; x < GAME_WIDTH; x++) {
+            if (shown_valid && next_cells[y][x] == shown_cells[y][x]) continue;
 
-    // 1. 게임 테두리
-    mvhline(0, 1, ACS_HLINE, GAME_WIDTH - 2);
-    mvhline(GAME_HEIGHT - 1, 1, ACS_HLINE, GAME_WIDTH - 2);
-    mvvline(1, 0, ACS_VLINE, GAME_HEIGHT - 2);
-    mvvline(1, GAME_WIDTH - 1, ACS_VLINE, GAME_HEIGHT - 2);
-    mvaddch(0, 0, ACS_ULCORNER);                    // 좌상단
-    mvaddch(0, GAME_WIDTH - 1, ACS_URCORNER);       // 우상단
-    mvaddch(GAME_HEIGHT - 1, 0, ACS_LLCORNER);      // 좌하단
-    mvaddch(GAME_HEIGHT - 1, GAME_WIDTH - 1, ACS_LRCORNER); // 우하단
-
-    // 특수 웨이브 효과 끄기
-    if (game_state->special_wave > 0 && (frame % 10 < 5)) {
-        attroff(A_REVERSE | A_BOLD);
+            if (cursor != x) move(y, x);
+            addch(next_cells[y][x]);
+            shown_cells[y][x] = next_cells[y][x];
+            cursor = x + 1;
+        }
     }
+    shown_valid = 1;
+}
+
+void draw_game(const GameState* game_state, int id, int frame) {
+    if (!border_ready) build_border();
 
-    // 2. 레드존
-    if (has_colors()) attron(COLOR_PAIR(2)); // 배경까지 빨간색
+    // 1. 게임 테두리 (정적 레이어 복사)
+    // 특수 웨이브 경고 효과: 10프레임 중 5프레임은 반전/굵게 표시하여 깜빡이는 효과를 줌
+    memcpy(next_cells, border_cells, sizeof(next_cells));
+    int effects = output.quality < VIEW_QUALITY_PLAIN;  // 깜빡임/반전 효과 사용 여부
+    if (effects && game_state->special_wave > 0 && (frame % 10 < 5)) {
+        for (int x = 0; x < GAME_WIDTH; x++) {
+            next_cells[0][x] |= A_REVERSE | A_BOLD;
+            next_cells[GAME_HEIGHT - 1][x] |= A_REVERSE | A_BOLD;
+        }
+        for (int y = 1; y < GAME_HEIGHT - 1; y++) {
+            next_cells[y][0] |= A_REVERSE | A_BOLD;
+            next_cells[y][GAME_WIDTH - 1] |= A_REVERSE | A_BOLD;
+        }
+    }
+
+    // 2. 레드존 (배경까지 빨간색)
     for (int i = 0; i < MAX_REDZONES; i++) {
         if (game_state->redzone[i].active) {
             for (int y = 0; y < game_state->redzone[i].height; y++) {
                 for (int x = 0; x < game_state->redzone[i].width; x++) {
                     int py = game_state->redzone[i].y + y;
                     int px = game_state->redzone[i].x + x;
+                    // 출력량을 줄이는 단계에서는 테두리만 글자색으로 표시
+                    int edge = y == 0 || x == 0 ||
+                               y == game_state->redzone[i].height - 1 ||
+                               x == game_state->redzone[i].width - 1;
+                    chtype cell = '#' | color_attr(2);
+                    if (output.quality >= VIEW_QUALITY_OUTLINE) {
+                        if (!edge) continue;
+                        cell = '#' | color_attr(1);
+                    }
                     // 화면 범위 내에만 출력
                     if (py > 0 && py < GAME_HEIGHT - 1 && px > 0 && px < GAME_WIDTH - 1)
-                        mvaddch(py, px, '#');
+                        next_cells[py][px] = cell;
                 }
             }
         }
     }
-    if (has_colors()) attroff(COLOR_PAIR(2));
 
     // 3. 플레이어 그리기
     for (int i = 0; i < 2; i++) {
@@ -75,16 +264,15 @@ void draw_game(const GameState* game_state, int id, int frame) {
         
         char p_char = (i == 0) ? '@' : '$'; // P1: @, P2: $
         int color = (i == id) ? 3 : 6; // 나: 노랑(3), 상대: 파랑(6)
-        int attrs = 0;
+        chtype attrs = 0;
 
         // 무적 상태이거나 피격 후 쿨타임 중일 때 깜빡임 효과 
-        if (i == id && (game_state->player[i].invincible || game_state->player[i].damage_cooldown > 0)) {
+        if (effects && i == id && (game_state->player[i].invincible || game_state->player[i].damage_cooldown > 0)) {
             if (frame % 4 < 2) attrs = A_BOLD; // 밝게 표시 
         }
 
-        if (has_colors()) attron(COLOR_PAIR(color) | attrs);
-        mvaddch(game_state->player[i].y, game_state->player[i].x, p_char);
-        if (has_colors()) attroff(COLOR_PAIR(color) | attrs);
+        put_cell(game_state->player[i].y, game_state->player[i].x,
+                 p_char | (has_colors() ? color_attr(color) | attrs : 0));
     }
 
     // 4. 화살 그리기
@@ -93,7 +281,7 @@ void draw_game(const GameState* game_state, int id, int frame) {
         if (!game_state->arrow[i].active) continue;
         
         int color = 0;
-        int attr = 0;
+        chtype attr = 0;
 
         if (game_state->arrow[i].special == 2) { // 플레이어가 발사한 공격
             attr = A_BOLD;
@@ -111,39 +299,49 @@ void draw_game(const GameState* game_state, int id, int frame) {
              color = 5; // 화살 색 변경 (청록)
         } 
 
-        if (has_colors() && color) attron(COLOR_PAIR(color) | attr);
-        mvaddch(game_state->arrow[i].y, game_state->arrow[i].x, game_state->arrow[i].symbol);
-        if (has_colors() && color) attroff(COLOR_PAIR(color) | attr);
+        chtype ch = (chtype)(unsigned char)game_state->arrow[i].symbol;
+        if (!effects) attr = 0;
+        if (has_colors() && color) ch |= color_attr(color) | attr;
+        put_cell(game_state->arrow[i].y, game_state->arrow[i].x, ch);
     }
 
     // 5. UI 및 정보 표시
     int opponent_id = (id == 0) ? 1 : 0;
     
     // 상단: 점수 및 생명력(하트) 표시
-    mvprintw(0, 2, " P%d Score:%d ", id + 1, game_state->player[id].score);
-    mvprintw(0, 45, " Lives:");
-    for(int i=0; i<game_state->player[id].lives; i++) addstr("<3");
+    put_text(0, 2, 0, " P%d Score:%d ", id + 1, game_state->player[id].score);
+    int x = put_text(0, 45, 0, " Lives:");
+    for(int i=0; i<game_state->player[id].lives; i++) x = put_text(0, x, 0, "<3");
     
     // 상대방 생명력 표시 (연결된 경우만)
     if (game_state->player[opponent_id].connected) {
-        mvprintw(0, 65, " Enemy:");
-        for(int k=0; k<game_state->player[opponent_id].lives; k++) addstr("<3");
+        x = put_text(0, 65, 0, " Enemy:");
+        for(int k=0; k<game_state->player[opponent_id].lives; k++) x = put_text(0, x, 0, "<3");
     }
 
     // 특수 웨이브 알림 텍스트
-    if (game_state->special_wave > 0) mvprintw(1, 2, " SPECIAL WAVE! ");
+    if (game_state->special_wave > 0) put_text(1, 2, 0, " SPECIAL WAVE! ");
 
-    // 하단: 보유 아이템 개수 표시
-    if (has_colors()) attron(COLOR_PAIR(4)); // 초록색
-    mvprintw(GAME_HEIGHT-1, 2, "[1]Inv:%d [2]Heal:%d [3]Slow:%d", 
+    // 하단: 보유 아이템 개수 표시 (초록색)
+    put_text(GAME_HEIGHT-1, 2, color_attr(4), "[1]Inv:%d [2]Heal:%d [3]Slow:%d", 
         game_state->player[id].invincible_item,
         game_state->player[id].heal_item,
         game_state->player[id].slow_item);
-    if (has_colors()) attroff(COLOR_PAIR(4));
+
+    // 터미널 출력량 (품질을 낮췄거나 SPACEWAR_STATS 일 때)
+    if (show_output || output.quality > 0) {
+        char stat[32];
+        int len = snprintf(stat, sizeof(stat), " tty %.1fKB/s Q%d ",
+                           output.bytes_per_sec / 1024.0, output.quality);
+        put_text(GAME_HEIGHT - 1, GAME_WIDTH - 2 - len, 0, "%s", stat);
+    }
+
+    flush_cells();
 }
 
 
 void gameOverScreen(int winner_id, int id, int score) {
+    view_invalidate();
     clear();
     box(stdscr, 0, 0); // 테두리
     attron(A_BOLD);
@@ -159,6 +357,7 @@ void gameOverScreen(int winner_id, int id, int score) {
 
 
 void singleGameOverScreen(int score, int level) {
+    view_invalidate();
     clear();
     if (has_colors()) attron(COLOR_PAIR(1) | A_BOLD); // 빨간색 강조
     box(stdscr, 0, 0);